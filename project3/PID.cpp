@@ -16,64 +16,91 @@
 #include "logger.h"
 
 PID::PID(PIDConstants *newConstants, float minError, float maxError) {
-	_constants.kp = newConstants->kp;
-	_constants.ki = newConstants->ki;
-	_constants.kd = newConstants->kd;
+	setConstants(newConstants);
 	_minError = minError;
 	_maxError = maxError;
-	// zero out integrator error
-	for (int i = 0; i < NUM_INTEGRATOR_VALUES; i++) {
-		_integratorValues[i] = 0.0;
-	}
+	flushPID();
 }
 
 /**************************************
- * Definition: Updates the PID control with a new value and
- *             returns the gain
+ * Definition: Updates the PID control with a new value, taken
+ *             one sample (PID_SAMPLE_TIME) after the last one,
+ *             and returns the gain
  *
  * Parameters: a float error
  *
  * Returns:    a float specifying gain
  **************************************/
 float PID::updatePID(float error) {
-	float prevError = lastError();
-	// add the error to the integrator list
-	addErrorToIntegrator(error);
+	return updatePID(error, PID_SAMPLE_TIME);
+}
 
-	/**
-	 * total term should = 1 at error = 10
-	 * 
-	 * pTerm should almost max out when error > 10
-	 * suggested value: 0.9
-	 * 
-	 * iTerm should max out at maxValue/minValue and should affect the speed by that much
-	 * 	i.e. if the sum is greater than 100 (the last 10 reads have been greater than 10)
-	 * then the value that we get should be maxValue for iTerm
-	 * suggested value: 0.5
-	 * 
-	 * dTerm shouldn't really do much, since the bot probably won't jump around too much 
-	 * and so the robot should not take too much of this into account
-	 * suggested value = 0.05
-	 */
+/**************************************
+ * Definition: Updates the PID control with a new value and
+ *             returns the gain
+ *
+ * 	           pTerm should almost max out when error is large.
+ * 	           
+ * 	           iTerm is held within PID_ITERM_LIMIT of the error
+ * 	           range, and stops growing while the gain is pinned at
+ * 	           0 or 1 in the direction of the error, so it can't wind 
+ * 	           up while the robot is already going as fast as it can.
+ *
+ * 	           dTerm shouldn't really do much, since the bot probably 
+ * 	           won't jump around too much, and it's low pass filtered 
+ * 	           so sensor noise doesn't make it jump either.
+ *
+ * Parameters: a float error and the float time in seconds since
+ *             the last update
+ *
+ * Returns:    a float specifying gain
+ **************************************/
+float PID::updatePID(float error, float dt) {
+	if (dt <= 0.0) {
+		dt = PID_SAMPLE_TIME;
+	}
+	float samples = dt / PID_SAMPLE_TIME;
 
 	// get proportional term of the PID control
-	float pTerm = _constants.kp * error;						
-	// get integral term of the PID control
-	float iTerm = _constants.ki * currentIntegratorError();	
-	// check that the integrator is not too high 
-	if (iTerm > _maxError * 0.10) {							
-		iTerm = 0.1;
-    }
-	else if (iTerm < _minError * 0.10) {
-		iTerm = -0.1;
-    }
+	float pTerm = _constants.kp * error;
+
+	// get differential term from the (filtered) change in error
+	if (_haveLastError) {
+		float rawDerivative = (error - _lastError) / samples;
+		float alpha = dt / (PID_DERIVATIVE_TAU + dt);
+		_derivative += alpha * (rawDerivative - _derivative);
+	}
+	_lastError = error;
+	_haveLastError = true;
+	float dTerm = _constants.kd * _derivative;
+
+	// get integral term, only integrating if the gain isn't already
+	// saturated in the direction this error would push it
+	float iTerm = _constants.ki * _integral;
+	float unclipped = pTerm + iTerm + dTerm;
+	bool saturated = (unclipped >= 1.0 && error > 0) || 
+	                 (unclipped <= 0.0 && error < 0);
+	if (!saturated) {
+		_integral += error * samples;
+		iTerm = _constants.ki * _integral;
+	}
 
-    // get differential term by multiplying by the change in error 
-	float dTerm = _constants.kd * (error - prevError);
+	// keep the integrator from winding past its limits
+	float maxITerm = _maxError * PID_ITERM_LIMIT;
+	float minITerm = _minError * PID_ITERM_LIMIT;
+	if (iTerm > maxITerm) {
+		iTerm = maxITerm;
+		_integral = _constants.ki != 0.0 ? maxITerm / _constants.ki : 0.0;
+	}
+	else if (iTerm < minITerm) {
+		iTerm = minITerm;
+		_integral = _constants.ki != 0.0 ? minITerm / _constants.ki : 0.0;
+	}
 
-    LOG.write(LOG_LOW, "pid terms", "pTerm = %f", pTerm);
-	LOG.write(LOG_LOW, "pid terms", "iTerm = %f", iTerm);
-	LOG.write(LOG_LOW, "pid terms", "dTerm = %f", dTerm);
+#if PID_LOG
+	LOG.write(LOG_LOW, "pid terms", "pTerm = %f iTerm = %f dTerm = %f", 
+	          pTerm, iTerm, dTerm);
+#endif
 
 	float gain = pTerm + iTerm + dTerm;
 	if (gain > 1.0) {
@@ -91,34 +118,20 @@ float PID::updatePID(float error) {
  *             reached the destination and want to remove the error
  **************************************/
 void PID::flushPID() {
-	for (int i = 0; i < NUM_INTEGRATOR_VALUES; i++) {
-		_integratorValues[i] = 0.0;
-	}
+	_integral = 0.0;
+	_derivative = 0.0;
+	_lastError = 0.0;
+	_haveLastError = false;
 }
 
 /**************************************
- * Definition: Adds an error to the fixed-size integrator list 
+ * Definition: Returns the current integrator error
  *
- * Parameters: a float error
- **************************************/
-void PID::addErrorToIntegrator(float error) {
-	for (int i = NUM_INTEGRATOR_VALUES-1; i > 0; i--) {
-		_integratorValues[i] = _integratorValues[i-1];
-	}
-	_integratorValues[0] = error;
-}
-
-/**************************************
- * Definition: Returns the current integrator error (sum of errors)
- *
- * Returns:    a float error representing the sum of integrator errors
+ * Returns:    a float error representing the integrated errors
+ *             (in samples of PID_SAMPLE_TIME)
  **************************************/
 float PID::currentIntegratorError() {
-	float error = 0.0;
-	for (int i = 0; i < NUM_INTEGRATOR_VALUES; i++) {
-		error += _integratorValues[i];
-	}
-	return error;
+	return _integral;
 }
 
 /**************************************
@@ -127,7 +140,7 @@ float PID::currentIntegratorError() {
  * Returns:    a float error
  **************************************/
 float PID::lastError() {
-	return _integratorValues[0];
+	return _lastError;
 }
 
 /**************************************
@@ -15,30 +15,48 @@
 #ifndef CS1567_PID_H
 #define CS1567_PID_H
 
-#include "pose.h"
+#include "constants.h"
 #include <stdio.h>
 #include <stdlib.h>
 
-#define NUM_INTEGRATOR_VALUES 10
+// The gains are per sample of this many seconds (they were tuned
+// with one update per control loop pass), so updates with other 
+// time steps are scaled to match
+#define PID_SAMPLE_TIME (1.0 / CONTROL_RATE)
+
+// time constant of the low pass filter on the derivative, in seconds
+#define PID_DERIVATIVE_TAU 0.1
+
+// the integral term is held within this fraction of the error range
+#define PID_ITERM_LIMIT 0.1
+
+// build with -DPID_LOG=1 to log every term of every update
+#ifndef PID_LOG
+#define PID_LOG 0
+#endif
 
 typedef struct {
-	float ki, kp, kd;
+	float kp, ki, kd;
 } PIDConstants;
 
 class PID {
 public:
 	PID(PIDConstants *constants, float minError, float maxError);
 	float updatePID(float error);
+	float updatePID(float error, float dt);
 	void flushPID();
-	void addErrorToIntegrator(float error);
 	float currentIntegratorError();
 	float lastError();
 	void setConstants(PIDConstants *newConstants);
 private:
-	float _integratorValues[NUM_INTEGRATOR_VALUES];
 	PIDConstants _constants;
 	float _minError;
 	float _maxError;
+
+	float _integral;     // sum of error * (dt / PID_SAMPLE_TIME)
+	float _derivative;   // filtered change in error per sample
+	float _lastError;
+	bool _haveLastError;
 };
 
 #endif
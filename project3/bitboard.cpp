@@ -0,0 +1,100 @@
+/**
+ * bitboard.cpp
+ *
+ * @brief
+ *      This class keeps the game map as a set of 64 bit masks, a bit
+ *      per cell (cell (x, y) is bit y * MAP_WIDTH + x), plus the points
+ *      of every cell in a flat array, so the planners can step around
+ *      the board with shifts and masks instead of going through Cells.
+ *      The Map keeps it in sync with its cells.
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#include "bitboard.h"
+
+BitBoard::BitBoard() {
+	clear();
+}
+
+BitBoard::~BitBoard() {}
+
+/**************************************
+ * Definition: Empties the board
+ **************************************/
+void BitBoard::clear() {
+	blocked = 0;
+	post = 0;
+	pellet = 0;
+	reserved = 0;
+	occupied = 0;
+	for (int i = 0; i < BOARD_CELLS; i++) {
+		points[i] = 0;
+	}
+}
+
+/**************************************
+ * Definition: Copies a cell's state onto its bit of every mask
+ *
+ * Parameters: the cell
+ **************************************/
+void BitBoard::setCell(Cell *cell) {
+	int index = indexOf(cell->x, cell->y);
+	uint64_t bit = bitAt(index);
+
+	blocked &= ~bit;
+	post &= ~bit;
+	pellet &= ~bit;
+	reserved &= ~bit;
+	occupied &= ~bit;
+
+	if (cell->isBlocked()) {
+		blocked |= bit;
+	}
+	if (cell->isPost()) {
+		post |= bit;
+	}
+	if (cell->isReserved()) {
+		reserved |= bit;
+	}
+	if (cell->isOccupied()) {
+		occupied |= bit;
+	}
+
+	int cellPoints = cell->getPoints();
+	if (cellPoints < 0) {
+		cellPoints = 0;
+	}
+	else if (cellPoints > 255) {
+		cellPoints = 255;
+	}
+	points[index] = cellPoints;
+	if (cellPoints > 0) {
+		pellet |= bit;
+	}
+}
+
+/**************************************
+ * Definition: Determines if a cell is on the board and not blocked
+ *
+ * Parameters: the cell's x and y
+ **************************************/
+bool BitBoard::canEnter(int x, int y) {
+	if (x < 0 || y < 0 || x >= MAP_WIDTH || y >= MAP_HEIGHT) {
+		return false;
+	}
+	return !(blocked & bitAt(indexOf(x, y)));
+}
+
+/**************************************
+ * Definition: Returns how many points a cell is worth
+ *
+ * Parameters: the cell's x and y
+ **************************************/
+int BitBoard::getPoints(int x, int y) {
+	return points[indexOf(x, y)];
+}
@@ -0,0 +1,69 @@
+/**
+ * bitboard.h
+ *
+ * @brief
+ *      This class keeps the game map as a set of 64 bit masks, a bit
+ *      per cell (cell (x, y) is bit y * MAP_WIDTH + x), plus the points
+ *      of every cell in a flat array, so the planners can step around
+ *      the board with shifts and masks instead of going through Cells.
+ *      The Map keeps it in sync with its cells.
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#ifndef CS1567_BITBOARD_H
+#define CS1567_BITBOARD_H
+
+#include "cell.h"
+
+#include <stdint.h>
+
+#define MAP_WIDTH 7
+#define MAP_HEIGHT 5
+
+#define BOARD_CELLS (MAP_WIDTH * MAP_HEIGHT)
+#define BOARD_ALL ((((uint64_t)1) << BOARD_CELLS) - 1)
+
+// the cells with x = 0 and x = MAP_WIDTH - 1, so a move east or west
+// can't wrap around onto the next row
+#define BOARD_FIRST_COLUMN ((uint64_t)0x10204081)
+#define BOARD_LAST_COLUMN (BOARD_FIRST_COLUMN << (MAP_WIDTH - 1))
+
+class BitBoard {
+public:
+	BitBoard();
+	~BitBoard();
+	void clear();
+	void setCell(Cell *cell);
+	bool canEnter(int x, int y);
+	int getPoints(int x, int y);
+
+	static int indexOf(int x, int y) {
+		return y * MAP_WIDTH + x;
+	}
+
+	static uint64_t bitAt(int index) {
+		return ((uint64_t)1) << index;
+	}
+
+	// every cell next to the given ones, blocked or not
+	static uint64_t neighbours(uint64_t cells) {
+		return (((cells << MAP_WIDTH) | (cells >> MAP_WIDTH)) |
+		        ((cells & ~BOARD_LAST_COLUMN) << 1) |
+		        ((cells & ~BOARD_FIRST_COLUMN) >> 1)) & BOARD_ALL;
+	}
+
+	uint64_t blocked;   // cells that can't be entered (see Cell::isBlocked)
+	uint64_t post;
+	uint64_t pellet;    // cells still worth points
+	uint64_t reserved;
+	uint64_t occupied;
+
+	uint8_t points[BOARD_CELLS];
+};
+
+#endif
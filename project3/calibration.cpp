@@ -0,0 +1,311 @@
+/**
+ * calibration.cpp
+ *
+ * @brief
+ *      This class loads the north star calibration (scale, rotation,
+ *      origin and theta shift for each room) of a single robot from a
+ *      calibration file, and uses it to transform north star readings
+ *      between room coordinates and the global coordinate system.
+ *      The file can be reloaded at runtime by sending the process the
+ *      reload signal (SIGHUP by default).
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#include "calibration.h"
+#include "utilities.h"
+#include "logger.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+volatile sig_atomic_t Calibration::_reloadGeneration = 0;
+
+Calibration::Calibration(std::string fileName)
+: _fileName(fileName) {
+    // start with identity transforms until the file is loaded
+    for (int i = 0; i < NUM_ROOMS; i++) {
+        _rooms[i].scaleX = 1.0;
+        _rooms[i].scaleY = 1.0;
+        _rooms[i].rotation = 0.0;
+        _rooms[i].originX = 0.0;
+        _rooms[i].originY = 0.0;
+        _rooms[i].thetaShift = 0.0;
+        _valid[i] = false;
+    }
+    _loadedGeneration = _reloadGeneration;
+    load();
+}
+
+Calibration::~Calibration() {}
+
+/**************************************
+ * Definition: Maps the calibration file into memory and parses it.
+ *             If anything goes wrong, the previously loaded values
+ *             are kept so a bad edit can't break a running robot.
+ *
+ * Returns:    true if the file was loaded
+ **************************************/
+bool Calibration::load() {
+    int fd = open(_fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG.write(LOG_HIGH, "calibration",
+                  "Unable to open calibration file %s", _fileName.c_str());
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        LOG.write(LOG_HIGH, "calibration",
+                  "Calibration file %s is empty", _fileName.c_str());
+        close(fd);
+        return false;
+    }
+
+    void *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        LOG.write(LOG_HIGH, "calibration",
+                  "Unable to map calibration file %s", _fileName.c_str());
+        return false;
+    }
+
+    RoomCalibration rooms[NUM_ROOMS];
+    bool valid[NUM_ROOMS];
+    bool parsed = _parse((const char *)data, info.st_size, rooms, valid);
+    munmap(data, info.st_size);
+
+    if (!parsed) {
+        LOG.write(LOG_HIGH, "calibration",
+                  "No rooms found in calibration file %s", _fileName.c_str());
+        return false;
+    }
+
+    for (int i = 0; i < NUM_ROOMS; i++) {
+        if (valid[i]) {
+            _rooms[i] = rooms[i];
+            _valid[i] = true;
+        }
+    }
+
+    LOG.write(LOG_MED, "calibration",
+              "Loaded calibration file %s", _fileName.c_str());
+    return true;
+}
+
+/**************************************
+ * Definition: Reloads the calibration file if the reload signal
+ *             has been received since the last load
+ *
+ * Returns:    true if the file was reloaded
+ **************************************/
+bool Calibration::reloadIfRequested() {
+    if (_loadedGeneration == _reloadGeneration) {
+        return false;
+    }
+    _loadedGeneration = _reloadGeneration;
+    return load();
+}
+
+/**************************************
+ * Definition: Returns whether the given room has been calibrated
+ *
+ * Parameters: int specifying the room (starting at 0)
+ **************************************/
+bool Calibration::hasRoom(int room) {
+    return room >= 0 && room < NUM_ROOMS && _valid[room];
+}
+
+/**************************************
+ * Definition: Returns the calibration for the given room
+ *
+ * Parameters: int specifying the room (starting at 0)
+ *
+ * Returns:    a pointer to the room's calibration, or NULL
+ *             if the room has not been calibrated
+ **************************************/
+RoomCalibration* Calibration::getRoom(int room) {
+    if (!hasRoom(room)) {
+        return NULL;
+    }
+    return &_rooms[room];
+}
+
+/**************************************
+ * Definition: Transforms a pose in the given room's north star
+ *             coordinates into the global coordinate system
+ *
+ * Parameters: int specifying the room and the pose to transform
+ **************************************/
+void Calibration::toGlobal(int room, Pose *pose) {
+    RoomCalibration *cal = &_rooms[room];
+
+    if (room == ROOM_2) {
+        // Apply specific linear transformation to Room 2,
+        // to correct for theta skew
+        float xFitAngle = 0.0000204488 * pose->getX() - 0.0804;
+        float yFitAngle = 0.0000204488 * pose->getY() - 0.0804;
+        pose->rotateEach(xFitAngle, yFitAngle, cal->rotation);
+    }
+    else {
+        pose->rotate(cal->rotation);
+    }
+
+    pose->rotateEach(0, 0, cal->thetaShift);
+    pose->scale(cal->scaleX, cal->scaleY);
+    pose->translate(COL_OFFSET[0] + cal->originX,
+                    COL_OFFSET[1] + cal->originY);
+}
+
+/**************************************
+ * Definition: Transforms a global x and y back into the given
+ *             room's north star coordinates (theta is left alone)
+ *
+ * Parameters: int specifying the room and the pose to transform
+ **************************************/
+void Calibration::toRoom(int room, Pose *pose) {
+    RoomCalibration *cal = &_rooms[room];
+
+    pose->translate(-COL_OFFSET[0] - cal->originX,
+                    -COL_OFFSET[1] - cal->originY);
+    pose->scale(1.0/cal->scaleX, 1.0/cal->scaleY);
+    pose->rotate(-cal->rotation);
+}
+
+/**************************************
+ * Definition: Returns the path of the file this calibration
+ *             was loaded from
+ **************************************/
+std::string Calibration::getFileName() {
+    return _fileName;
+}
+
+/**************************************
+ * Definition: Returns the default calibration file path for a robot
+ *
+ * Parameters: int specifying the robot's name
+ **************************************/
+std::string Calibration::fileNameFor(int name) {
+    return std::string(CALIBRATION_DIR) + ROBOTS[name] + CALIBRATION_EXT;
+}
+
+/**************************************
+ * Definition: Writes a calibration file in the format read by load()
+ *
+ * Parameters: the file to write, the robot's name, and an array of
+ *             NUM_ROOMS calibrations along with which of them are valid
+ *
+ * Returns:    true on success
+ **************************************/
+bool Calibration::write(std::string fileName, std::string robotName,
+                        RoomCalibration *rooms, bool *valid) {
+    FILE *file = fopen(fileName.c_str(), "w");
+    if (file == NULL) {
+        return false;
+    }
+
+    fprintf(file, "# north star calibration for %s\n", robotName.c_str());
+    fprintf(file, "# room\tscale_x\tscale_y\trotation\t"
+                  "origin_x\torigin_y\ttheta_shift\n");
+    for (int i = 0; i < NUM_ROOMS; i++) {
+        if (!valid[i]) {
+            continue;
+        }
+        fprintf(file, "%d\t%.2f\t%.2f\t%.4f\t%.1f\t%.1f\t%.4f\n",
+                i + 2,
+                rooms[i].scaleX, rooms[i].scaleY,
+                rooms[i].rotation,
+                rooms[i].originX, rooms[i].originY,
+                rooms[i].thetaShift);
+    }
+
+    fclose(file);
+    return true;
+}
+
+/**************************************
+ * Definition: Installs a handler so that the given signal causes
+ *             every calibration to reload on its next use
+ *
+ * Parameters: int specifying the signal (ie, SIGHUP)
+ **************************************/
+void Calibration::watchSignal(int signum) {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = _onSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(signum, &action, NULL);
+}
+
+void Calibration::_onSignal(int) {
+    _reloadGeneration = _reloadGeneration + 1;
+}
+
+/**************************************
+ * Definition: Parses the mapped calibration file. Each non-comment
+ *             line holds one room:
+ *
+ *             room scale_x scale_y rotation origin_x origin_y theta_shift
+ *
+ *             where room is the north star room id (2-5)
+ *
+ * Returns:    true if at least one room was read
+ **************************************/
+bool Calibration::_parse(const char *data, size_t size,
+                         RoomCalibration *rooms, bool *valid) {
+    bool found = false;
+    for (int i = 0; i < NUM_ROOMS; i++) {
+        valid[i] = false;
+    }
+
+    size_t pos = 0;
+    while (pos < size) {
+        // copy out a single line, since the mapping isn't terminated
+        char line[256];
+        size_t len = 0;
+        while (pos < size && data[pos] != '\n') {
+            if (len < sizeof(line) - 1) {
+                line[len++] = data[pos];
+            }
+            pos++;
+        }
+        line[len] = '\0';
+        pos++;
+
+        char *start = line;
+        while (*start == ' ' || *start == '\t') {
+            start++;
+        }
+        if (*start == '#' || *start == '\0' || *start == '\r') {
+            continue;
+        }
+
+        int roomId;
+        RoomCalibration cal;
+        int numRead = sscanf(start, "%d %f %f %f %f %f %f", &roomId,
+                             &cal.scaleX, &cal.scaleY, &cal.rotation,
+                             &cal.originX, &cal.originY, &cal.thetaShift);
+        int room = roomId - 2;
+        if (numRead != 7 || room < 0 || room >= NUM_ROOMS ||
+            cal.scaleX == 0 || cal.scaleY == 0) {
+            LOG.write(LOG_HIGH, "calibration",
+                      "Skipping bad calibration line: %s", start);
+            continue;
+        }
+
+        rooms[room] = cal;
+        valid[room] = true;
+        found = true;
+    }
+
+    return found;
+}
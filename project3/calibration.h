@@ -0,0 +1,67 @@
+/**
+ * calibration.h
+ *
+ * @brief
+ *      This class loads the north star calibration (scale, rotation,
+ *      origin and theta shift for each room) of a single robot from a
+ *      calibration file, and uses it to transform north star readings
+ *      between room coordinates and the global coordinate system.
+ *      The file can be reloaded at runtime by sending the process the
+ *      reload signal (SIGHUP by default).
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#ifndef CS1567_CALIBRATION_H
+#define CS1567_CALIBRATION_H
+
+#include "pose.h"
+#include "constants.h"
+
+#include <signal.h>
+#include <string>
+
+#define CALIBRATION_DIR "calibration/"
+#define CALIBRATION_EXT ".cal"
+
+typedef struct {
+    float scaleX, scaleY;         // ticks per cm
+    float rotation;               // radians, relative to room 2's base
+    float originX, originY;       // cm from the column corner
+    float thetaShift;             // radians
+} RoomCalibration;
+
+class Calibration {
+public:
+    Calibration(std::string fileName);
+    ~Calibration();
+    bool load();
+    bool reloadIfRequested();
+    bool hasRoom(int room);
+    RoomCalibration* getRoom(int room);
+    void toGlobal(int room, Pose *pose);
+    void toRoom(int room, Pose *pose);
+    std::string getFileName();
+
+    static std::string fileNameFor(int name);
+    static bool write(std::string fileName, std::string robotName,
+                      RoomCalibration *rooms, bool *valid);
+    static void watchSignal(int signum);
+private:
+    std::string _fileName;
+    RoomCalibration _rooms[NUM_ROOMS];
+    bool _valid[NUM_ROOMS];
+    int _loadedGeneration;
+
+    bool _parse(const char *data, size_t size,
+                RoomCalibration *rooms, bool *valid);
+
+    static volatile sig_atomic_t _reloadGeneration;
+    static void _onSignal(int signum);
+};
+
+#endif
@@ -13,9 +13,11 @@
  **/
 
 #include "camera.h"
+#include "sensor_thread.h"
 #include "logger.h"
 #include "utilities.h"
 #include <math.h>
+#include <string.h>
 
 int Camera::prevTagState = -1;
 
@@ -28,6 +30,8 @@ Camera::Camera(RobotInterface *robotInterface) {
     setQuality(CAMERA_QUALITY);
     setResolution(CAMERA_RESOLUTION);
 
+    memset(&_centerStats, 0, sizeof(_centerStats));
+
     // create 3 windows that will be used to display
     // what is happening during processing of images
     cvNamedWindow("Thresholded", CV_WINDOW_AUTOSIZE);
@@ -46,6 +50,7 @@ Camera::~Camera() {
         delete _yellowSquares;
     // TODO: close windows
     // place the head back down since the camera is no longer being used
+    InterfaceLock lock;
     _robotInterface->Move(RI_HEAD_DOWN, 1);
 }
 
@@ -58,6 +63,7 @@ Camera::~Camera() {
  * 
  **************************************/
 void Camera::setQuality(int quality) {
+    InterfaceLock lock;
     if (_robotInterface->CameraCfg(RI_CAMERA_DEFAULT_BRIGHTNESS, 
                                    RI_CAMERA_DEFAULT_CONTRAST, 
                                    5, 
@@ -80,6 +86,7 @@ void Camera::setQuality(int quality) {
  * 
  **************************************/
 void Camera::setResolution(int resolution) {
+    InterfaceLock lock;
     if (_robotInterface->CameraCfg(RI_CAMERA_DEFAULT_BRIGHTNESS, 
                                    RI_CAMERA_DEFAULT_CONTRAST, 
                                    5, 
@@ -198,9 +205,20 @@ int Camera::getTagState(int color) {
     }
 }
 
-float Camera::centerError(int color, bool *turn) {
-    *turn = false;
-   
+/**************************************
+ * Definition: Gives the error to correct by turning and the error
+ *             to correct by strafing. Each of the slope and center
+ *             distance errors goes to whichever of the two it says
+ *             it's better fixed by, averaged over NUM_CAMERA_ERRORS
+ *             frames (or, with CAMERA_SEQUENTIAL, as few frames as it
+ *             takes to be sure, up to CAMERA_MAX_ERRORS).
+ *
+ * Parameters: the color of the squares to look at, and where to
+ *             store the turn and strafe errors and how certain
+ *             each one is (either error is 0 if nothing went to it)
+ **************************************/
+void Camera::centerErrors(int color, float *turnError, float *strafeError,
+                          float *turnCertainty, float *strafeCertainty) {
     int curTagState = 5;
 
     float slopeTurnCertainty = 0;
@@ -233,10 +251,25 @@ float Camera::centerError(int color, bool *turn) {
     float avgSlopeCertainty = 0;
     float avgCenterDistCertainty = 0;
 
-    // calculate slope and center distance errors the specified number
-    // of times, ignoring -999's (which say they found nothing good)
-    for (int i = 0; i < NUM_CAMERA_ERRORS; i++) {
+    CenterReadings slopeReadings = {0, 0, 0.0, 0.0, 0.0};
+    CenterReadings centerDistReadings = {0, 0, 0.0, 0.0, 0.0};
+
+    // calculate slope and center distance errors until they're certain
+    // enough (or up to the specified number of times, or more if they
+    // disagree), ignoring -999's (which say they found nothing good)
+    int numFrames = 0;
+    int maxFrames = CAMERA_SEQUENTIAL ? CAMERA_MAX_ERRORS : NUM_CAMERA_ERRORS;
+    for (int i = 0; i < maxFrames; i++) {
+        if (CAMERA_SEQUENTIAL && i > 0) {
+            int agreement = _agreement(&slopeReadings, &centerDistReadings);
+            if (agreement == CENTER_CERTAIN ||
+                (agreement == CENTER_UNSURE && i >= NUM_CAMERA_ERRORS)) {
+                break;
+            }
+        }
+
         update();
+        numFrames++;
 
         bool slopeTurn = false;
         bool centerDistTurn = false;
@@ -253,6 +286,7 @@ float Camera::centerError(int color, bool *turn) {
         curTagState = getTagState(color) < curTagState ? getTagState(color) : curTagState;
 
         if (slopeCertainty > 0.01) {
+            _addReading(&slopeReadings, slopeError, slopeTurn, slopeCertainty);
             if (slopeTurn) {
                 numSlopeTurnErrors++;
                 slopeTurnCertainty += slopeCertainty;
@@ -266,6 +300,8 @@ float Camera::centerError(int color, bool *turn) {
         }
 
         if (centerDistCertainty > 0.01) {
+            _addReading(&centerDistReadings, centerDistError, 
+                        centerDistTurn, centerDistCertainty);
             if (centerDistTurn) {
                 numCenterDistTurnErrors++;
                 centerDistTurnCertainty += centerDistCertainty;
@@ -279,6 +315,18 @@ float Camera::centerError(int color, bool *turn) {
         }
     }
 
+    // keep track of how many frames each decision costs
+    _centerStats.decisions++;
+    _centerStats.frames += numFrames;
+    _centerStats.histogram[numFrames]++;
+    if (numFrames < NUM_CAMERA_ERRORS) {
+        _centerStats.earlyExits++;
+    }
+    else if (numFrames > NUM_CAMERA_ERRORS) {
+        _centerStats.extended++;
+    }
+    LOG.write(LOG_LOW, "centerError", "frames used: %d", numFrames);
+
     if (numSlopeTurnErrors == 0) {
         avgSlopeTurn = false;
     } 
@@ -424,74 +472,167 @@ float Camera::centerError(int color, bool *turn) {
         }
     }
 
-    float turnCertainty = 0.0;
-    float strafeCertainty = 0.0;
-
-    if(avgSlopeTurn) {
-        turnCertainty += numSlopeTurnErrors * avgSlopeCertainty;
-    } 
-    else {
-        strafeCertainty += numSlopeStrafeErrors * avgSlopeCertainty;
-    }
-
-    if(avgCenterDistTurn) {
-        turnCertainty +=  numCenterDistTurnErrors * avgCenterDistCertainty;
-    } 
-    else {
-        strafeCertainty += numCenterDistStrafeErrors * avgCenterDistCertainty;
-    }
-
-    if (turnCertainty > strafeCertainty) {
-        *turn = true;
-        
-    }
-    else {
-        *turn = false;
-    }
+    *turnCertainty = 0.0;
+    *strafeCertainty = 0.0;
 
     // TODO: if necessary, modify total error based on each certainty
     //
-    float totalError = 0.0;
-    int numErrors = 0;
-    if (*turn) {
+    float turnTotal = 0.0;
+    float strafeTotal = 0.0;
+    int numTurnErrors = 0;
+    int numStrafeErrors = 0;
+
+    if (numGoodSlopeErrors > 0) {
         if (avgSlopeTurn) {
-            numErrors++;
-            totalError += avgSlopeError;
+            *turnCertainty += numSlopeTurnErrors * avgSlopeCertainty;
+            turnTotal += avgSlopeError;
+            numTurnErrors++;
         }
-
-        if (avgCenterDistTurn) {
-            numErrors++;
-            totalError += avgCenterDistError;
+        else {
+            *strafeCertainty += numSlopeStrafeErrors * avgSlopeCertainty;
+            strafeTotal += avgSlopeError;
+            numStrafeErrors++;
         }
     }
-    else {
-        if (!avgSlopeTurn) {
-            numErrors++;
-            totalError += avgSlopeError;
-        }
 
-        if (!avgCenterDistTurn) {
-            numErrors++;
-            totalError += avgCenterDistError;
+    if (numGoodCenterDistErrors > 0) {
+        if (avgCenterDistTurn) {
+            *turnCertainty += numCenterDistTurnErrors * avgCenterDistCertainty;
+            turnTotal += avgCenterDistError;
+            numTurnErrors++;
+        }
+        else {
+            *strafeCertainty += numCenterDistStrafeErrors * avgCenterDistCertainty;
+            strafeTotal += avgCenterDistError;
+            numStrafeErrors++;
         }
     }
 
+    *turnError = numTurnErrors == 0 ? 0.0 : turnTotal / numTurnErrors;
+    *strafeError = numStrafeErrors == 0 ? 0.0 : strafeTotal / numStrafeErrors;
+
     LOG.write(LOG_LOW, "centerError", "avgSlopeError: %f",
               avgSlopeError);
     LOG.write(LOG_LOW, "centerError", "avgCenterDistError: %f",
               avgCenterDistError);
-    LOG.write(LOG_LOW, "centerError", "totalError: %f",
-              totalError);
-    LOG.write(LOG_LOW, "centerError", "numErrors: %d",
-              numErrors);
+    LOG.write(LOG_LOW, "centerError", "turn error: %f (certainty %f)",
+              *turnError, *turnCertainty);
+    LOG.write(LOG_LOW, "centerError", "strafe error: %f (certainty %f)",
+              *strafeError, *strafeCertainty);
 
     prevTagState = curTagState;
+}
+
+/**************************************
+ * Definition: Gives the turn and strafe errors (see the other 
+ *             centerErrors) without their certainties
+ **************************************/
+void Camera::centerErrors(int color, float *turnError, float *strafeError) {
+    float turnCertainty;
+    float strafeCertainty;
+    centerErrors(color, turnError, strafeError, 
+                 &turnCertainty, &strafeCertainty);
+}
+
+/**************************************
+ * Definition: Gives a single center error, from whichever of turning
+ *             and strafing the camera is more certain about
+ *
+ * Parameters: the color of the squares to look at, and where to
+ *             store whether the error should be fixed by turning
+ *
+ * Returns:    the error, in the interval [-1, 1]
+ **************************************/
+float Camera::centerError(int color, bool *turn) {
+    float turnError;
+    float strafeError;
+    float turnCertainty;
+    float strafeCertainty;
+    centerErrors(color, &turnError, &strafeError, 
+                 &turnCertainty, &strafeCertainty);
+
+    *turn = turnCertainty > strafeCertainty;
+    return *turn ? turnError : strafeError;
+}
+
+/**************************************
+ * Definition: Adds one frame's slope or center distance error to
+ *             the running totals used to decide when to stop
+ *             taking frames
+ **************************************/
+void Camera::_addReading(CenterReadings *readings, float error, 
+                         bool turn, float certainty) {
+    readings->count++;
+    if (turn) {
+        readings->turnVotes++;
+    }
+    readings->sum += error;
+    readings->sumSquares += error * error;
+    readings->certainty += certainty;
+}
+
+/**************************************
+ * Definition: Decides whether the frames taken so far are enough
+ *
+ * Returns:    CENTER_CERTAIN if every kind of error that was found is
+ *             certain enough and its readings are close together and
+ *             agree on turning or strafing, CENTER_DISAGREE if any
+ *             of them are spread out or split on turning, and
+ *             CENTER_UNSURE otherwise (including when nothing has
+ *             been found)
+ **************************************/
+int Camera::_agreement(CenterReadings *slope, CenterReadings *centerDist) {
+    CenterReadings *all[2] = {slope, centerDist};
+    bool found = false;
+    bool certain = true;
+    for (int i = 0; i < 2; i++) {
+        CenterReadings *r = all[i];
+        if (r->count == 0) {
+            continue;
+        }
+        found = true;
 
-    if (numErrors == 0) {
-        return 0.0;
+        float mean = r->sum / r->count;
+        float variance = r->sumSquares / r->count - mean * mean;
+        bool split = r->turnVotes != 0 && r->turnVotes != r->count;
+        if (variance > CAMERA_EXIT_VARIANCE || split) {
+            return CENTER_DISAGREE;
+        }
+        if (r->certainty / r->count < CAMERA_EXIT_CERTAINTY) {
+            certain = false;
+        }
     }
+    return found && certain ? CENTER_CERTAIN : CENTER_UNSURE;
+}
+
+/**************************************
+ * Definition: Copies out how many frames the center error decisions
+ *             have taken so far
+ *
+ * Parameters: a pointer to a CenterStats struct to fill
+ **************************************/
+void Camera::getCenterStats(CenterStats *stats) {
+    *stats = _centerStats;
+}
 
-    return totalError / (float)numErrors;
+/**************************************
+ * Definition: Logs how many frames the center error decisions
+ *             have taken so far
+ **************************************/
+void Camera::logCenterStats() {
+    if (_centerStats.decisions == 0) {
+        return;
+    }
+    LOG.write(LOG_MED, "center_stats",
+              "decisions: %d \t frames per decision: %f \t "
+              "early exits: %d \t extended: %d",
+              _centerStats.decisions, 
+              (float)_centerStats.frames / _centerStats.decisions,
+              _centerStats.earlyExits, _centerStats.extended);
+    for (int i = 1; i <= CAMERA_MAX_ERRORS; i++) {
+        LOG.write(LOG_MED, "center_stats", "%d frames: %d decisions",
+                  i, _centerStats.histogram[i]);
+    }
 }
 
 /**************************************
@@ -1359,7 +1500,12 @@ IplImage* Camera::getBGRImage() {
     }
     IplImage *bgr = cvCreateImage(size, IPL_DEPTH_8U, 3);
 
-    if (_robotInterface->getImage(bgr) != RI_RESP_SUCCESS) {
+    int response;
+    {
+        InterfaceLock lock;
+        response = _robotInterface->getImage(bgr);
+    }
+    if (response != RI_RESP_SUCCESS) {
         LOG.write(LOG_HIGH, "camera image", 
                   "Unable to get an image!");
         bgr = NULL;
@@ -97,6 +97,19 @@
 // center error 
 #define NUM_CAMERA_ERRORS 3
 
+// stop taking images as soon as the errors are certain enough and
+// agree with each other, and take more (up to CAMERA_MAX_ERRORS)
+// when they disagree, instead of always taking NUM_CAMERA_ERRORS
+#define CAMERA_SEQUENTIAL true
+#define CAMERA_MAX_ERRORS 5
+#define CAMERA_EXIT_CERTAINTY 0.7 // average certainty of each error
+#define CAMERA_EXIT_VARIANCE 0.01 // variance of each error
+
+// whether the images taken so far are enough to decide on
+#define CENTER_CERTAIN 0
+#define CENTER_UNSURE 1
+#define CENTER_DISAGREE 2
+
 #define TAGS_BOTH_GE_TWO 0 // >= 2 tags on both sides
 #define TAGS_BOTH_ONE 1 // 1 tag on both sides
 #define TAGS_ONE_OR_NONE 2 // 1 or no tags
@@ -111,6 +124,24 @@ typedef struct regLine {
 	int numSquares;
 } regressionLine;
 
+// running totals of one kind of center error (slope or center
+// distance) over the images taken for a decision
+typedef struct {
+    int count;
+    int turnVotes;     // how many said to turn rather than strafe
+    float sum;
+    float sumSquares;
+    float certainty;
+} CenterReadings;
+
+typedef struct {
+    int decisions;
+    int frames;
+    int earlyExits;    // decisions made with fewer than NUM_CAMERA_ERRORS
+    int extended;      // decisions that needed more than NUM_CAMERA_ERRORS
+    int histogram[CAMERA_MAX_ERRORS + 1]; // decisions by frames used
+} CenterStats;
+
 class Camera {
 public:
 	Camera(RobotInterface *robotInterface);
@@ -122,6 +153,9 @@ public:
 	int getTagState(int color);
 	float centerError(int color, int prevTagState, bool *turn);
 	float centerError(int color, bool *turn);
+	void centerErrors(int color, float *turnError, float *strafeError);
+	void centerErrors(int color, float *turnError, float *strafeError,
+	                  float *turnCertainty, float *strafeCertainty);
 	float centerDistanceError(int color, bool *turn, float *certainty);
 	float corridorSlopeError(int color, bool *turn, float *certainty);
 	regressionLine leastSquaresRegression(int color, int side);	
@@ -137,6 +171,9 @@ public:
 	IplImage* getBGRImage();
 	IplImage* getThresholdedImage(CvScalar low, CvScalar high);
  
+    void getCenterStats(CenterStats *stats);
+    void logCenterStats();
+ 
     static int prevTagState;
 private:
 	RobotInterface *_robotInterface;
@@ -146,7 +183,11 @@ private:
 	IplImage *_yellowThresholded;
 	squares_t *_pinkSquares;
 	squares_t *_yellowSquares;
- 
+	CenterStats _centerStats;
+
+	void _addReading(CenterReadings *readings, float error, 
+	                 bool turn, float certainty);
+	int _agreement(CenterReadings *slope, CenterReadings *centerDist);
 };
 
 #endif
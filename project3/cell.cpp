@@ -1,4 +1,5 @@
 #include "cell.h"
+#include "sensor_thread.h"
 
 
 // we don't know what robot we are yet in the game 
@@ -14,6 +15,7 @@ Cell::Cell(map_obj_t *mapObj) {
 	setOccupied(false);
 	setReserved(false);
 	setPost(false);
+	clearOpenings();
 	switch (_type) {
 	case MAP_OBJ_EMPTY:
 		setPoints(0);
@@ -48,10 +50,13 @@ void Cell::claimRobot() {
  *             to the given map object
  *
  * Parameters: map_obj_t object at this cell's x and y
+ *
+ * Returns:    true if anything about the cell changed
  **************************************/
-void Cell::update(map_obj_t *mapObj) {
-	// TODO: check this to make sure it's correct
-	_openings=0;
+bool Cell::update(map_obj_t *mapObj) {
+	int points = getPoints();
+	bool occupied = isOccupied();
+	bool reserved = isReserved();
 
 	switch (mapObj->type) {
 	case MAP_OBJ_EMPTY:
@@ -75,6 +80,9 @@ void Cell::update(map_obj_t *mapObj) {
 		}
 		break;
 	}
+
+	return points != getPoints() || occupied != isOccupied() ||
+	       reserved != isReserved();
 }
 
 /**************************************
@@ -87,6 +95,7 @@ void Cell::update(map_obj_t *mapObj) {
  **************************************/
 bool Cell::occupy(RobotInterface *robotInterface) {
 	if (!isOccupied()) {
+		InterfaceLock lock;
 		if (robotInterface->updateMap(x, y) == RI_RESP_SUCCESS) {
 			setOccupied(true);
 			return true;
@@ -105,6 +114,7 @@ bool Cell::occupy(RobotInterface *robotInterface) {
  **************************************/
 bool Cell::reserve(RobotInterface *robotInterface) {
 	if (!isReserved()) {
+		InterfaceLock lock;
 		if (robotInterface->reserveMap(x, y) == RI_RESP_SUCCESS) {
 			setReserved(true);
 			return true;
@@ -191,6 +201,10 @@ void Cell::deleteOpening(unsigned char direction) {
 	_openings = _openings & (~direction);
 }
 
+void Cell::clearOpenings() {
+	_openings = 0;
+}
+
 int Cell::getOpenings() {
 	return _openings;
 }
\ No newline at end of file
@@ -18,7 +18,7 @@ public:
 	Cell(map_obj_t *mapObj);
 	~Cell();
 	void claimRobot();
-	void update(map_obj_t *mapObj);
+	bool update(map_obj_t *mapObj);
 	bool occupy(RobotInterface *robotInterface);
 	bool reserve(RobotInterface *robotInterface);
 	int getPoints();
@@ -33,6 +33,7 @@ public:
 	
 	void addOpening(unsigned char dir);
 	void deleteOpening(unsigned char direction);
+	void clearOpenings();
     int getOpenings();
 	int getCellType();
 	
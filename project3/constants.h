@@ -31,6 +31,8 @@
 
 #define MAX_UPDATE_FAILS 5 // max allowable fails to update robot interface
 
+#define CONTROL_RATE 20 // Hz, how often the control loops tick
+
 // Kalman uncertainties
 // process uncertainties
 #define PROC_X_UNCERTAIN 0.10
@@ -47,38 +49,61 @@
 #define WE_Y_UNCERTAIN 0.05
 #define WE_THETA_UNCERTAIN 0.15
 
+// These are the gains the loops were tuned with. PIDConstants used to
+// declare ki before kp, so what was written as P was used as I and the
+// other way around, and they're kept that way round until retuned
+// gains (data/tune_pid) have been tried on the robots.
+
 // Distance PID
-#define PID_MOVE_KP 0.8
-#define PID_MOVE_KI 0.05
+#define PID_MOVE_KP 0.05
+#define PID_MOVE_KI 0.8
 #define PID_MOVE_KD 0.05
 
 #define MIN_MOVE_ERROR 0
 #define MAX_MOVE_ERROR 65
 
 // Turn PID (based on theta error)
-#define PID_TURN_KP 0.8
-#define PID_TURN_KI 0.15
+#define PID_TURN_KP 0.15
+#define PID_TURN_KI 0.8
 #define PID_TURN_KD 0.05
 
 #define MIN_TURN_ERROR -3.14159
 #define MAX_TURN_ERROR 3.14159
 
 // Turn PID (based on center error)
-#define PID_CENTERTURN_KP 0.8
-#define PID_CENTERTURN_KI 0.35
+#define PID_CENTERTURN_KP 0.35
+#define PID_CENTERTURN_KI 0.8
 #define PID_CENTERTURN_KD 0.30
 
 #define MIN_CENTERTURN_ERROR -1.0
 #define MAX_CENTERTURN_ERROR 1.0
 
 // Strafe PID (based on center error)
-#define PID_CENTERSTRAFE_KP 0.8
-#define PID_CENTERSTRAFE_KI 0.25
+#define PID_CENTERSTRAFE_KP 0.25
+#define PID_CENTERSTRAFE_KI 0.8
 #define PID_CENTERSTRAFE_KD 0.30
 
 #define MIN_CENTERSTRAFE_ERROR -1.0
 #define MAX_CENTERSTRAFE_ERROR 1.0
 
+// plan move and turn speeds with a motion profile (see MotionProfile)
+// instead of from the move and turn PID gains
+#define USE_MOTION_PROFILE true
+
+// stop moves early, by how far the robot coasts after a stop
+// (see StopModel), instead of once they're within MAX_DIST_ERROR.
+// Off until each robot has a calibration/<robot>.stop fitted by
+// data/fit_stop from its own drive logs
+#define USE_STOP_MODEL false
+
+// pick cells by searching the game against the opponent (see
+// GameSearch), instead of by the best path for us alone
+#define USE_GAME_SEARCH true
+
+// plan the move after the next one while driving to the next one
+// (see Planner), instead of once we get there
+#define USE_BACKGROUND_PLANNER true
+
 // acceptable proximities from base
 #define MAX_DIST_ERROR 20.0 // in cm
 #define MAX_THETA_ERROR DEGREE_20/2.0
@@ -95,10 +120,36 @@
 #define ROOM_4 2
 #define ROOM_5 3
 
+#define NUM_ROOMS 4
+
+// blend north star estimates from neighbouring rooms near room
+// boundaries instead of switching rooms outright (see RoomBlender)
+#define NS_BLEND_ROOMS false
+
 #define WE_SCALE 4.0 // (avg) ticks per cm
 
+// wheels with bad encoders (or'd together), which are left out
+// of the odometry (see WheelEncoders)
+#define WE_FAULT_NONE 0
+#define WE_FAULT_LEFT 1
+#define WE_FAULT_RIGHT 2
+#define WE_FAULT_REAR 4
+
+const int WE_FAULTS[6] = {
+	WE_FAULT_RIGHT, // rosie
+	WE_FAULT_NONE,  // bender
+	WE_FAULT_NONE,  // johnny5
+	WE_FAULT_LEFT,  // optimus
+	WE_FAULT_NONE,  // walle
+	WE_FAULT_NONE   // gort
+};
+
 /* north star transformation constants */
 
+// The per-robot scale, rotation, origin and theta shift for each room
+// live in calibration/<robot>.cal (see calibration.h) so they can be
+// refit with data/fit_calibration and reloaded without a rebuild.
+
 // Notes regarding room scale values:
 //   Rooms 2 and 3 Y values vary greatly depending on robot orientation within 
 //   the corridor (moving via strafe or straight)
@@ -108,40 +159,6 @@
 //	 Room 2 may be dodgy at end of corridor (X and Y)
 //	 High quality values: NS2x, NS5x, (lesser so) NS3x, NS5y
 
-// the average ticks per cm in x and y per room per robot
-const float NS_ROOM_SCALE[6][4][2] = {
-	// Rosie
-	{{49.2, 37.1}, 
-     {45.4, 57.6}, 
-	 {59.6, 36.7}, 
-	 {37.4, 53.5}},
-	// Bender
-	{{58.1, 52.3},		
-	 {58.8, 47.5},
-	 {59.6, 36.7},
-	 {53.6, 71.7}},
-	// Johnny5 (using Bender's)
-	{{58.1, 52.3},		
-	 {58.8, 47.5},
-	 {59.6, 36.7},
-	 {53.6, 71.7}},
-	// Optimus (using Bender's)
-	{{58.1, 52.3},		
-	 {58.8, 47.5},
-	 {59.6, 36.7},
-	 {53.6, 71.7}},
-	// WallE (using Bender's)
-	{{58.1, 52.3},		
-	 {58.8, 47.5},
-	 {59.6, 36.7},
-	 {53.6, 71.7}},
-	// Gort (using Bender's)
-	{{58.1, 52.3},		
-	 {58.8, 47.5},
-	 {59.6, 36.7},
-	 {53.6, 71.7}}
-};
-
 // ROTATION is angle relative to room 2's base where 0 degrees is parallel to far wall
 // Theta increases counter-clockwise     |
 //    |-door-|                           |
@@ -160,110 +177,9 @@ const float NS_ROOM_SCALE[6][4][2] = {
 //     origin                            |
 //_______________________________________|
 
-const float NS_ROOM_ROTATION[6][4] = {
-	// Rosie
-	{0.0, 
-     1.5708, 
-     0.0, 
-     1.6005},
-	// Bender
-	{0.0, 
-     1.6708,
-     0.15, 
-     1.6005},
-	// Johnny5 (using Bender's)
-	{0.0, 
-     1.6708, 
-     0.15, 
-     1.6005},
-	// Optimus (using Bender's)
-	{0.0, 
-     1.6708, 
-     0.15, 
-     1.6005},
-	// WallE (using Bender's)
-	{0.0, 
-     1.6708, 
-     0.15, 
-     1.6005},
-    // Gort (using Bender's)
-    {0.0,
-     1.6708,
-     0.15,
-     1.6005}
-};
-
 // the distance of column top-right corner from base 0 in cm
+// (room origins in the calibration files are measured from this
+// corner, labeled with a * in above map)
 const float COL_OFFSET[2] = {193.0, 234.0};
 
-// the distances of ns origins from column corner (labeled with a * in above map)
-// Note: Don't trust room 4 for Gort or Bender
-const float NS_ROOM_ORIGINS_FROM_COL[6][4][2] = {
-	// Rosie
-	{{18.0, -124.0},
-	 {-147.0, 8.0},
-	 {41.0, 168.0},
-	 {196.0, 30.0}},
-	// Bender
-	{{36.0,-125.0}, 
-	 {-116.0,18.0}, 
-	 {62.0, 174.0}, 
-	 {193.0, 36.0}},
-	// Johnny5
-	{{5.0, -104.0}, 
-	 {-144.0, 25.0}, 
-	 {32.0, 200.0}, 
-	 {195.0, 32.0}},
-	// Optimus (using Bender's)
-	{{36.0,-125.0}, 
-	 {-116.0,18.0}, 
-	 {62.0, 174.0}, 
-	 {193.0, 36.0}},
-	// WallE (using Bender's)
-	{{36.0,-125.0}, 
-	 {-116.0,18.0}, 
-	 {62.0, 174.0}, 
-	 {193.0, 36.0}},
-	// Gort
-	{{48.0,-97.0}, 
-	 {-95.0,32.0}, 
-	 {84.0, 191.0}, 
-	 {212.0, 102.0}}
-};
-
-
-// Value necessary to push the theta = 0 onto the x-axis rather than the y					  
-const float THETA_SHIFT[6][4] = {
-	// Rosie
-	{1.5708, 
-	 -1.5708, 
-	 1.5708, 
-	 -1.5708},
-	// Bender (using Rosie's)
-	{1.5708, 
-	 -1.5708, 
-	 1.5708, 
-	 -1.5708},
-	// Johnny5 (using Rosie's)
-	{1.5708, 
-	 -1.5708, 
-	 1.5708, 
-	 -1.5708},
-	// Optimus (using Rosie's)
-	{1.5708, 
-	 -1.5708, 
-	 1.5708, 
-	 -1.5708},
-	// WallE (using Rosie's)
-	{1.5708, 
-	 -1.5708, 
-	 1.5708, 
-	 -1.5708},
-	// Gort (using Rosie's)
-	{1.5708, 
-	 -1.5708, 
-	 1.5708, 
-	 -1.5708}
-};
-
 #endif
@@ -0,0 +1,319 @@
+/**
+ * fit_calibration.cpp
+ *
+ * @brief
+ *      Fits the north star calibration (scale, rotation, origin and theta
+ *      shift for each room) of a robot from logs recorded with gather_data
+ *      while sitting at known global positions, and writes it out as a
+ *      calibration file that the robot picks up on start (or on SIGHUP).
+ *
+ *      The points file has one recorded position per line:
+ *
+ *          <log base path> <global x (cm)> <global y (cm)> <global theta>
+ *
+ *      where <log base path>_ns_raw and <log base path>_room are the logs.
+ *      Each room needs 3 positions that aren't in a line (2 for room 2,
+ *      whose rotation comes from its skew correction instead). Rooms
+ *      without enough positions keep the values from the base file.
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#include "../calibration.h"
+#include "../utilities.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+
+typedef struct {
+    float rawX, rawY, rawTheta;
+    float x, y, theta;
+} FitPoint;
+
+/**************************************
+ * Definition: Solves the normal equations of a linear least squares
+ *             problem with up to 3 unknowns by gaussian elimination
+ *
+ * Parameters: rows of n inputs, their outputs, n, and the solution
+ *
+ * Returns:    false if the system is singular
+ **************************************/
+bool leastSquares(std::vector<std::vector<double> > &rows,
+                  std::vector<double> &outputs, int n, double *solution) {
+    double m[3][4];
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j <= n; j++) {
+            m[i][j] = 0;
+        }
+    }
+    for (size_t r = 0; r < rows.size(); r++) {
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                m[i][j] += rows[r][i] * rows[r][j];
+            }
+            m[i][n] += rows[r][i] * outputs[r];
+        }
+    }
+
+    for (int col = 0; col < n; col++) {
+        int pivot = col;
+        for (int i = col+1; i < n; i++) {
+            if (fabs(m[i][col]) > fabs(m[pivot][col])) {
+                pivot = i;
+            }
+        }
+        if (fabs(m[pivot][col]) < 1e-9) {
+            return false;
+        }
+        for (int j = 0; j <= n; j++) {
+            double tmp = m[col][j];
+            m[col][j] = m[pivot][j];
+            m[pivot][j] = tmp;
+        }
+        for (int i = 0; i < n; i++) {
+            if (i == col) {
+                continue;
+            }
+            double factor = m[i][col] / m[col][col];
+            for (int j = col; j <= n; j++) {
+                m[i][j] -= factor * m[col][j];
+            }
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        solution[i] = m[i][n] / m[i][i];
+    }
+    return true;
+}
+
+/**************************************
+ * Definition: Reads the ns_raw and room logs for one position and
+ *             averages the raw readings seen in each room
+ *
+ * Returns:    the number of samples read
+ **************************************/
+int readPosition(std::string base, float x, float y, float theta,
+                 std::vector<FitPoint> *points) {
+    std::ifstream nsFile((base + "_ns_raw").c_str());
+    std::ifstream roomFile((base + "_room").c_str());
+
+    double sumX[NUM_ROOMS] = {0};
+    double sumY[NUM_ROOMS] = {0};
+    double sumSin[NUM_ROOMS] = {0};
+    double sumCos[NUM_ROOMS] = {0};
+    int count[NUM_ROOMS] = {0};
+    int total = 0;
+
+    std::string nsLine, roomLine;
+    while (std::getline(nsFile, nsLine) && std::getline(roomFile, roomLine)) {
+        float rawX, rawY, rawTheta;
+        if (sscanf(nsLine.c_str(), "%f,%f,%f", &rawX, &rawY, &rawTheta) != 3) {
+            continue;
+        }
+        int room = atoi(roomLine.c_str()) - 2;
+        if (room < 0 || room >= NUM_ROOMS) {
+            continue;
+        }
+        sumX[room] += rawX;
+        sumY[room] += rawY;
+        sumSin[room] += sin(rawTheta);
+        sumCos[room] += cos(rawTheta);
+        count[room]++;
+        total++;
+    }
+
+    for (int room = 0; room < NUM_ROOMS; room++) {
+        if (count[room] == 0) {
+            continue;
+        }
+        FitPoint point;
+        point.rawX = sumX[room] / count[room];
+        point.rawY = sumY[room] / count[room];
+        point.rawTheta = atan2(sumSin[room], sumCos[room]);
+        point.x = x;
+        point.y = y;
+        point.theta = theta;
+        points[room].push_back(point);
+    }
+
+    return total;
+}
+
+/**************************************
+ * Definition: Fits a single room's calibration from its points
+ *
+ * Returns:    false if there weren't enough points
+ **************************************/
+bool fitRoom(int room, std::vector<FitPoint> &points, RoomCalibration *cal) {
+    std::vector<std::vector<double> > rows;
+    std::vector<double> outX, outY;
+    double solX[3], solY[3];
+
+    if (room == ROOM_2) {
+        // room 2's position rotation is the skew correction applied
+        // by Calibration::toGlobal, so only fit scale and origin here
+        if (points.size() < 2) {
+            return false;
+        }
+        std::vector<std::vector<double> > rowsY;
+        for (size_t i = 0; i < points.size(); i++) {
+            Pose skewed(points[i].rawX, points[i].rawY, 0);
+            float xFitAngle = 0.0000204488 * points[i].rawX - 0.0804;
+            float yFitAngle = 0.0000204488 * points[i].rawY - 0.0804;
+            skewed.rotateEach(xFitAngle, yFitAngle, 0);
+
+            std::vector<double> row(2), rowY(2);
+            row[0] = skewed.getX();
+            row[1] = 1.0;
+            rowY[0] = skewed.getY();
+            rowY[1] = 1.0;
+            rows.push_back(row);
+            rowsY.push_back(rowY);
+            outX.push_back(points[i].x);
+            outY.push_back(points[i].y);
+        }
+        if (!leastSquares(rows, outX, 2, solX) ||
+            !leastSquares(rowsY, outY, 2, solY)) {
+            return false;
+        }
+        cal->scaleX = 1.0 / solX[0];
+        cal->scaleY = 1.0 / solY[0];
+        cal->rotation = 0.0;
+        cal->originX = solX[1] - COL_OFFSET[0];
+        cal->originY = solY[1] - COL_OFFSET[1];
+    }
+    else {
+        if (points.size() < 3) {
+            return false;
+        }
+        for (size_t i = 0; i < points.size(); i++) {
+            std::vector<double> row(3);
+            row[0] = points[i].rawX;
+            row[1] = points[i].rawY;
+            row[2] = 1.0;
+            rows.push_back(row);
+            outX.push_back(points[i].x);
+            outY.push_back(points[i].y);
+        }
+        if (!leastSquares(rows, outX, 3, solX) ||
+            !leastSquares(rows, outY, 3, solY)) {
+            return false;
+        }
+        // the fitted matrix is diag(1/sx, 1/sy) * R(rotation), so each
+        // row's length gives a scale and each row's angle the rotation
+        cal->scaleX = 1.0 / sqrt(solX[0]*solX[0] + solX[1]*solX[1]);
+        cal->scaleY = 1.0 / sqrt(solY[0]*solY[0] + solY[1]*solY[1]);
+        float rotationX = atan2(-solX[1], solX[0]);
+        float rotationY = atan2(solY[0], solY[1]);
+        cal->rotation = atan2(sin(rotationX) + sin(rotationY),
+                              cos(rotationX) + cos(rotationY));
+        cal->originX = solX[2] - COL_OFFSET[0];
+        cal->originY = solY[2] - COL_OFFSET[1];
+    }
+
+    // global theta = raw theta - rotation - theta shift
+    double sumSin = 0;
+    double sumCos = 0;
+    for (size_t i = 0; i < points.size(); i++) {
+        float shift = points[i].rawTheta - cal->rotation - points[i].theta;
+        sumSin += sin(shift);
+        sumCos += cos(shift);
+    }
+    cal->thetaShift = atan2(sumSin, sumCos);
+
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        printf("ERROR: Invalid number of args -> should be:\n"
+               "%s [robot name] [points file] [output file (optional)]\n",
+               argv[0]);
+        return -1;
+    }
+
+    int name = Util::nameFrom(argv[1]);
+    std::string outFile = argc > 3 ? argv[3] : "../" + Calibration::fileNameFor(name);
+
+    // start from the existing calibration so rooms we have no data for
+    // are left alone
+    Calibration base(outFile);
+    RoomCalibration rooms[NUM_ROOMS];
+    bool valid[NUM_ROOMS];
+    for (int i = 0; i < NUM_ROOMS; i++) {
+        valid[i] = base.hasRoom(i);
+        if (valid[i]) {
+            rooms[i] = *base.getRoom(i);
+        }
+    }
+
+    std::vector<FitPoint> points[NUM_ROOMS];
+    std::ifstream pointsFile(argv[2]);
+    std::string line;
+    while (std::getline(pointsFile, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream in(line);
+        std::string logBase;
+        float x, y, theta;
+        if (!(in >> logBase >> x >> y >> theta)) {
+            continue;
+        }
+        int numSamples = readPosition(logBase, x, y, theta, points);
+        printf("%s: %d samples\n", logBase.c_str(), numSamples);
+    }
+
+    for (int room = 0; room < NUM_ROOMS; room++) {
+        RoomCalibration cal;
+        if (!fitRoom(room, points[room], &cal)) {
+            printf("room %d: not enough positions (%d), keeping old values\n",
+                   room+2, (int)points[room].size());
+            continue;
+        }
+        rooms[room] = cal;
+        valid[room] = true;
+        printf("room %d: scale (%f, %f) rotation %f origin (%f, %f) "
+               "theta shift %f\n", room+2, cal.scaleX, cal.scaleY,
+               cal.rotation, cal.originX, cal.originY, cal.thetaShift);
+    }
+
+    if (!Calibration::write(outFile, ROBOTS[name], rooms, valid)) {
+        printf("ERROR: unable to write %s\n", outFile.c_str());
+        return -2;
+    }
+
+    // check the fit by running each position back through the
+    // calibration exactly like the robot will
+    Calibration fitted(outFile);
+    for (int room = 0; room < NUM_ROOMS; room++) {
+        if (points[room].empty() || !fitted.hasRoom(room)) {
+            continue;
+        }
+        double sumSquares = 0;
+        for (size_t i = 0; i < points[room].size(); i++) {
+            FitPoint *p = &points[room][i];
+            Pose pose(p->rawX, p->rawY, p->rawTheta);
+            fitted.toGlobal(room, &pose);
+            float dx = pose.getX() - p->x;
+            float dy = pose.getY() - p->y;
+            sumSquares += dx*dx + dy*dy;
+        }
+        printf("room %d: rms error %f cm over %d positions\n", room+2,
+               sqrt(sumSquares / points[room].size()),
+               (int)points[room].size());
+    }
+
+    printf("wrote %s\n", outFile.c_str());
+    return 0;
+}
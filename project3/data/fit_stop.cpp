@@ -0,0 +1,97 @@
+/**
+ * fit_stop.cpp
+ *
+ * @brief
+ *      Fits how far a robot coasts after a stop at each speed level,
+ *      from recorded north star logs of it driving straight, and writes
+ *      them out as a stop file that the robot picks up on start (see
+ *      StopModel).
+ *
+ *      Each drive log is fitted with a first order lag plus dead time
+ *      (see PlantModel), and the robot is taken to keep going for the
+ *      dead time plus the time constant (on average) at the speed of
+ *      each level. The logs have no times, so the sample time comes
+ *      from a turning log recorded by the same program.
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#include "../stop_model.h"
+#include "../plant_model.h"
+#include "../utilities.h"
+#include "../logger.h"
+
+#include <stdio.h>
+#include <string>
+
+#define LOG_DIR "../../project1/data/logs/"
+#define TURN_LOG LOG_DIR "spinleft_middle_room2/spinleft_middle_room2.dat"
+
+const char *DEFAULT_LOGS[] = {
+    LOG_DIR "drive3mstop/drive3mstop.dat",
+    LOG_DIR "move/move_ns_raw.dat"
+};
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        printf("ERROR: Invalid number of args -> should be:\n"
+               "%s [robot name] [output file (optional)] "
+               "[drive logs (optional)]...\n", argv[0]);
+        return -1;
+    }
+    LOG.setImportanceLevel(LOG_HIGH);
+
+    int name = Util::nameFrom(argv[1]);
+    std::string outFile = argc > 2 ? argv[2] : "../" + StopModel::fileNameFor(name);
+
+    double sampleTime;
+    PlantModel turn;
+    if (!turn.fit(TURN_LOG, true, &sampleTime)) {
+        return -2;
+    }
+
+    float sumDeadTime = 0.0;
+    float sumTimeConstant = 0.0;
+    int numFits = 0;
+    int numLogs = argc > 3 ? argc - 3 : 2;
+    for (int i = 0; i < numLogs; i++) {
+        const char *log = argc > 3 ? argv[i + 3] : DEFAULT_LOGS[i];
+        PlantModel drive;
+        if (!drive.fit(log, false, &sampleTime)) {
+            continue;
+        }
+        sumDeadTime += drive.getDeadTime();
+        sumTimeConstant += drive.getTimeConstant();
+        numFits++;
+    }
+    if (numFits == 0) {
+        printf("ERROR: no drive logs could be fit\n");
+        return -3;
+    }
+
+    PlantModel model(sumDeadTime / numFits, sumTimeConstant / numFits);
+    printf("dead time %.3f s, time constant %.3f s\n", 
+           model.getDeadTime(), model.getTimeConstant());
+
+    StopModel stops;
+    for (int level = 1; level < NUM_SPEEDS; level++) {
+        float distance = model.getStopDistance(SPEED_FORWARD[level]);
+        // the lag is within 5% of stopped after 3 time constants
+        float settleTime = model.getDeadTime() + 3 * model.getTimeConstant();
+        stops.set(level, distance, settleTime);
+        printf("speed %d: %.1f cm/s, stops in %.1f cm\n", level, 
+               SPEED_FORWARD[level], distance);
+    }
+
+    if (!stops.write(outFile, ROBOTS[name])) {
+        printf("ERROR: unable to write %s\n", outFile.c_str());
+        return -4;
+    }
+
+    printf("wrote %s\n", outFile.c_str());
+    return 0;
+}
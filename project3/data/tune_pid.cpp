@@ -0,0 +1,384 @@
+/**
+ * tune_pid.cpp
+ *
+ * @brief
+ *      Tunes the gains of the robot's PID loops (move, turn, centerturn
+ *      and centerstrafe) against a simulated plant instead of the robot.
+ *
+ *      The plant is a first order lag plus dead time, fitted to the
+ *      step responses in recorded north star logs (drive3mstop for
+ *      driving, spinleft_middle_room2 for turning), with the speed of
+ *      each speed level taken from the SPEED_FORWARD and SPEED_TURN
+ *      tables. Each loop is simulated with the same speed and timing
+ *      rules as robot.cpp.
+ *
+ *      A relay feedback experiment on the model gives the ultimate
+ *      gain and period, which seed Ziegler-Nichols gains. A grid of
+ *      gains around that seed is then simulated from several starting
+ *      errors (split across threads), and the gains that get within
+ *      tolerance in the fewest updates, without overshooting, win.
+ *      Loops whose tuned gains don't beat the current ones keep them.
+ *
+ *      The gains are written to the robot's gains file, which the
+ *      robot loads on start (see PIDGains).
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#include "../PID.h"
+#include "../pid_gains.h"
+#include "../motion_profile.h"
+#include "../plant_model.h"
+#include "../utilities.h"
+#include "../logger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+#define LOG_DIR "../../project1/data/logs/"
+#define FORWARD_LOG LOG_DIR "drive3mstop/drive3mstop.dat"
+#define TURN_LOG LOG_DIR "spinleft_middle_room2/spinleft_middle_room2.dat"
+
+// how long one camera pass takes (grabbing and processing frames)
+#define CAMERA_PASS_TIME 1.0 // seconds
+
+// how far the robot has to turn or strafe to fix a center error of 1
+#define CENTER_TURN_PER_ERROR 0.45 // radians (half the camera's view)
+#define CENTER_STRAFE_PER_ERROR (65 / 2.0) // cm (half a cell)
+
+// how long the robot is left to coast after a loop finishes
+#define COAST_TIME 1.0 // seconds
+
+// updates charged for every tolerance's worth of error left
+// once the robot has come to rest
+#define OVERSHOOT_COST 5.0
+
+#define RELAY_ITERATIONS 200
+#define NUM_START_ERRORS 4
+
+typedef struct {
+    int loop;
+    int profile;
+    bool camera;        // updated once per camera pass, not per tick
+    float unitsPerError;
+    float minError, maxError;
+    float tolerance;
+    int maxIterations;
+    float startErrors[NUM_START_ERRORS];
+} LoopSetup;
+
+typedef struct {
+    const LoopSetup *setup;
+    const PlantModel *model;
+    const std::vector<PIDConstants> *candidates;
+    std::vector<float> *costs;
+    int first;
+    int step;
+} SearchJob;
+
+const LoopSetup LOOPS[NUM_PID_LOOPS] = {
+    {PID_LOOP_MOVE, PROFILE_FORWARD, false, 1.0,
+     MIN_MOVE_ERROR, MAX_MOVE_ERROR, MAX_DIST_ERROR, 300,
+     {65, 130, 195, 40}},
+    {PID_LOOP_TURN, PROFILE_TURN_LEFT, false, 1.0,
+     MIN_TURN_ERROR, MAX_TURN_ERROR, MAX_THETA_ERROR, 300,
+     {DEGREE_90, -DEGREE_90, DEGREE_180, DEGREE_45}},
+    {PID_LOOP_CENTERTURN, PROFILE_TURN_LEFT, true, CENTER_TURN_PER_ERROR,
+     MIN_CENTERTURN_ERROR, MAX_CENTERTURN_ERROR, MAX_TURN_CENTER_ERROR, 30,
+     {1.0, -1.0, 0.5, -0.3}},
+    {PID_LOOP_CENTERSTRAFE, PROFILE_FORWARD, true, CENTER_STRAFE_PER_ERROR,
+     MIN_CENTERSTRAFE_ERROR, MAX_CENTERSTRAFE_ERROR, MAX_STRAFE_CENTER_ERROR, 30,
+     {1.0, -1.0, 0.5, -0.3}}
+};
+
+// multiples of the seed gains to search over
+const float KP_SCALES[] = {0.25, 0.5, 0.75, 1.0, 1.5, 2.0, 3.0};
+const float KI_KD_SCALES[] = {0.0, 0.25, 0.5, 0.75, 1.0, 1.5, 2.0, 3.0};
+const int NUM_KP_SCALES = sizeof(KP_SCALES) / sizeof(KP_SCALES[0]);
+const int NUM_KI_KD_SCALES = sizeof(KI_KD_SCALES) / sizeof(KI_KD_SCALES[0]);
+
+/**************************************
+ * Definition: Drives the plant for one update of a loop, the same
+ *             way robot.cpp turns a gain into a command
+ *
+ * Parameters: the loop, the plant, the gain and the current error
+ *
+ * Returns:    the change in error
+ **************************************/
+float applyGain(const LoopSetup *setup, PlantModel *plant, float gain, float error) {
+    int speed = Util::capSpeed((int)(10 - 9 * gain), 10);
+    float direction = error < 0 ? -1.0 : 1.0;
+    float moved;
+
+    switch (setup->loop) {
+    case PID_LOOP_MOVE:
+        // moveToUntil only ever drives forward
+        moved = plant->run(MotionProfile::speedForLevel(setup->profile, speed),
+                           PID_SAMPLE_TIME);
+        return -moved / setup->unitsPerError;
+    case PID_LOOP_TURN:
+        moved = plant->run(direction *
+                           MotionProfile::speedForLevel(setup->profile, speed),
+                           PID_SAMPLE_TIME);
+        return -moved / setup->unitsPerError;
+    case PID_LOOP_CENTERTURN: {
+        // see Robot::_centerTurn
+        float turnLength = 0.3;
+        if (speed > 6) {
+            turnLength -= 0.05 * (speed - 6);
+            speed = 6;
+        }
+        moved = plant->run(direction *
+                           MotionProfile::speedForLevel(setup->profile, speed),
+                           turnLength);
+        moved += plant->run(0, CAMERA_PASS_TIME);
+        return -moved / setup->unitsPerError;
+    }
+    case PID_LOOP_CENTERSTRAFE:
+        // see Robot::_centerStrafe, strafes always go at speed 10
+        moved = plant->run(direction *
+                           MotionProfile::speedForLevel(setup->profile, 10),
+                           0.5 - 0.045 * speed);
+        moved += plant->run(0, CAMERA_PASS_TIME);
+        return -moved / setup->unitsPerError;
+    }
+    return 0;
+}
+
+/**************************************
+ * Definition: Simulates a loop from a starting error until it gets
+ *             within tolerance (or gives up), then lets it coast
+ *
+ * Returns:    the number of updates it took, plus OVERSHOOT_COST for
+ *             every tolerance's worth of error left once at rest
+ **************************************/
+float simulate(const LoopSetup *setup, const PlantModel *model,
+               PIDConstants *constants, float startError) {
+    PlantModel plant = *model;
+    plant.reset();
+    PID pid(constants, setup->minError, setup->maxError);
+
+    float error = startError;
+    int iterations = 0;
+    while (fabs(error) > setup->tolerance && iterations < setup->maxIterations) {
+        float gain;
+        if (setup->loop == PID_LOOP_MOVE) {
+            gain = pid.updatePID(fabs(error), PID_SAMPLE_TIME);
+        }
+        else if (setup->camera) {
+            gain = pid.updatePID(error);
+        }
+        else {
+            gain = pid.updatePID(error, PID_SAMPLE_TIME);
+        }
+        error += applyGain(setup, &plant, gain, error);
+        iterations++;
+    }
+
+    error -= plant.run(0, COAST_TIME) / setup->unitsPerError;
+
+    float leftOver = fabs(error) - setup->tolerance;
+    if (leftOver < 0) {
+        leftOver = 0;
+    }
+    return iterations + OVERSHOOT_COST * leftOver / setup->tolerance;
+}
+
+float cost(const LoopSetup *setup, const PlantModel *model,
+           PIDConstants *constants) {
+    float total = 0;
+    for (int i = 0; i < NUM_START_ERRORS; i++) {
+        total += simulate(setup, model, constants, setup->startErrors[i]);
+    }
+    return total;
+}
+
+/**************************************
+ * Definition: Runs a relay feedback experiment on the model (full
+ *             gain toward the goal, switching direction whenever the
+ *             error changes sign) and measures the limit cycle
+ *
+ * Parameters: the loop and plant, and where to store the amplitude
+ *             (in error units) and period (in updates)
+ *
+ * Returns:    false if the loop never settled into oscillating
+ **************************************/
+bool relay(const LoopSetup *setup, const PlantModel *model,
+           float *amplitude, float *period) {
+    PlantModel plant = *model;
+    plant.reset();
+
+    float error = setup->startErrors[0];
+    std::vector<int> crossings;
+    float maxError = 0;
+    float minError = 0;
+    for (int i = 0; i < RELAY_ITERATIONS; i++) {
+        float lastError = error;
+        error += applyGain(setup, &plant, 1.0, error);
+        if (i < RELAY_ITERATIONS / 2) {
+            continue;
+        }
+        maxError = std::max(maxError, error);
+        minError = std::min(minError, error);
+        if ((lastError < 0) != (error < 0)) {
+            crossings.push_back(i);
+        }
+    }
+
+    if (crossings.size() < 4) {
+        return false;
+    }
+    *amplitude = (maxError - minError) / 2.0;
+    *period = 2.0 * (crossings.back() - crossings.front()) /
+              (crossings.size() - 1);
+    return *amplitude > 0;
+}
+
+void* searchWorker(void *arg) {
+    SearchJob *job = (SearchJob *)arg;
+    for (size_t i = job->first; i < job->candidates->size(); i += job->step) {
+        PIDConstants constants = (*job->candidates)[i];
+        (*job->costs)[i] = cost(job->setup, job->model, &constants);
+    }
+    return NULL;
+}
+
+/**************************************
+ * Definition: Simulates every candidate, split across threads
+ *
+ * Returns:    the index of the cheapest candidate (the first one,
+ *             if several tie, so the result doesn't depend on the
+ *             number of threads)
+ **************************************/
+int search(const LoopSetup *setup, const PlantModel *model,
+           std::vector<PIDConstants> &candidates,
+           std::vector<float> &costs, int numThreads) {
+    costs.assign(candidates.size(), 0);
+
+    std::vector<pthread_t> threads(numThreads);
+    std::vector<SearchJob> jobs(numThreads);
+    for (int i = 0; i < numThreads; i++) {
+        jobs[i].setup = setup;
+        jobs[i].model = model;
+        jobs[i].candidates = &candidates;
+        jobs[i].costs = &costs;
+        jobs[i].first = i;
+        jobs[i].step = numThreads;
+        pthread_create(&threads[i], NULL, searchWorker, &jobs[i]);
+    }
+    for (int i = 0; i < numThreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    size_t best = 0;
+    for (size_t i = 1; i < costs.size(); i++) {
+        if (costs[i] < costs[best]) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        printf("ERROR: Invalid number of args -> should be:\n"
+               "%s [robot name] [output file (optional)]\n", argv[0]);
+        return -1;
+    }
+    LOG.setImportanceLevel(LOG_HIGH);
+
+    int name = Util::nameFrom(argv[1]);
+    std::string outFile = argc > 2 ? argv[2] : "../" + PIDGains::fileNameFor(name);
+
+    int numThreads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (numThreads < 1) {
+        numThreads = 1;
+    }
+
+    PlantModel forward;
+    PlantModel turn;
+    double sampleTime;
+    if (!turn.fit(TURN_LOG, true, &sampleTime) ||
+        !forward.fit(FORWARD_LOG, false, &sampleTime)) {
+        return -2;
+    }
+
+    // start from the robot's current gains
+    PIDGains gains;
+    gains.load(outFile);
+
+    for (int i = 0; i < NUM_PID_LOOPS; i++) {
+        const LoopSetup *setup = &LOOPS[i];
+        const PlantModel *model = setup->profile == PROFILE_FORWARD ? &forward : &turn;
+        PIDConstants current = *gains.get(setup->loop);
+        float sampleTime = setup->camera ? CAMERA_PASS_TIME : PID_SAMPLE_TIME;
+
+        // seed with Ziegler-Nichols gains from a relay experiment, with
+        // the integral and derivative gains per update (as PID wants)
+        PIDConstants seed = current;
+        float amplitude, period;
+        if (relay(setup, model, &amplitude, &period)) {
+            float ultimateGain = 4.0 / (PI * amplitude);
+            seed.kp = 0.6 * ultimateGain;
+            seed.ki = seed.kp / (period / 2.0);
+            seed.kd = seed.kp * (period / 8.0);
+            printf("%s: relay amplitude %.3f period %.1f updates "
+                   "(%.2f s), seed kp %.4f ki %.4f kd %.4f\n",
+                   PID_LOOP_NAMES[i], amplitude, period, period * sampleTime,
+                   seed.kp, seed.ki, seed.kd);
+        }
+        else {
+            printf("%s: no relay oscillation, searching around the "
+                   "current gains\n", PID_LOOP_NAMES[i]);
+        }
+
+        std::vector<PIDConstants> candidates;
+        for (int p = 0; p < NUM_KP_SCALES; p++) {
+            for (int q = 0; q < NUM_KI_KD_SCALES; q++) {
+                for (int d = 0; d < NUM_KI_KD_SCALES; d++) {
+                    PIDConstants candidate;
+                    candidate.kp = seed.kp * KP_SCALES[p];
+                    candidate.ki = seed.ki * KI_KD_SCALES[q];
+                    candidate.kd = seed.kd * KI_KD_SCALES[d];
+                    candidates.push_back(candidate);
+                }
+            }
+        }
+
+        std::vector<float> costs;
+        int best = search(setup, model, candidates, costs, numThreads);
+        float currentCost = cost(setup, model, &current);
+
+        printf("%s: current kp %.4f ki %.4f kd %.4f cost %.1f\n"
+               "%s: tuned   kp %.4f ki %.4f kd %.4f cost %.1f "
+               "(%d candidates)\n",
+               PID_LOOP_NAMES[i], current.kp, current.ki, current.kd,
+               currentCost, PID_LOOP_NAMES[i], candidates[best].kp,
+               candidates[best].ki, candidates[best].kd, costs[best],
+               (int)candidates.size());
+
+        if (costs[best] < currentCost) {
+            gains.set(setup->loop, &candidates[best]);
+        }
+        else {
+            printf("%s: keeping the current gains\n", PID_LOOP_NAMES[i]);
+        }
+    }
+
+    if (!gains.write(outFile, ROBOTS[name])) {
+        printf("ERROR: unable to write %s\n", outFile.c_str());
+        return -3;
+    }
+
+    printf("wrote %s\n", outFile.c_str());
+    return 0;
+}
@@ -0,0 +1,468 @@
+/**
+ * game_search.cpp
+ *
+ * @brief
+ *      This class picks our next cell by searching the game as two
+ *      players taking turns to move, us trying to get the most points
+ *      more than the opponent and them trying to get the most points
+ *      more than us. It's a minimax search with alpha-beta pruning,
+ *      deepened one round at a time until its time runs out, with the
+ *      best move of the last round and the richest cells tried first.
+ *
+ *      The game is played on the bit board (see BitBoard): any cell
+ *      either robot has been in is blocked from then on, like the
+ *      occupied cells on the map. States are hashed as they're played
+ *      (see Zobrist), and ones that have been searched before are
+ *      looked up in a transposition table instead.
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#include "game_search.h"
+#include "path.h"
+#include "utilities.h"
+#include "logger.h"
+
+#include <string.h>
+
+// larger than any score the game can reach
+#define GAME_INFINITY 1000000.0
+
+GameSearch::GameSearch(Map *map) {
+	_map = map;
+	_board = map->getBoard();
+	_bestMove = -1;
+	_aborted = false;
+	_stats.depth = 0;
+	_stats.nodes = 0;
+	_stats.time = 0.0;
+	_stats.value = 0.0;
+	_stats.complete = false;
+	memset(_tablePoints, 0, BOARD_CELLS);
+}
+
+GameSearch::~GameSearch() {}
+
+/**************************************
+ * Definition: Searches the game from where both robots are now
+ *             (see search)
+ *
+ * Parameters: the seconds the search can take
+ *
+ * Returns:    the cell to move to, or NULL if we can't move or
+ *             there are no points left that we could reach
+ **************************************/
+Cell* GameSearch::nextCell(double budget) {
+	Cell *ourCell = _map->getCurrentCell();
+	Cell *theirCell = _map->getOpponentCell();
+
+	int us = BitBoard::indexOf(ourCell->x, ourCell->y);
+	int them = -1;
+	if (theirCell != NULL && theirCell != ourCell) {
+		them = BitBoard::indexOf(theirCell->x, theirCell->y);
+	}
+
+	int move = search(_board, us, them, budget);
+	if (move == -1) {
+		return NULL;
+	}
+	return _map->cells[move % MAP_WIDTH][move / MAP_WIDTH];
+}
+
+/**************************************
+ * Definition: Searches the game on the given board, one round deeper
+ *             at a time, until the given time runs out, the search
+ *             is aborted (see abort) or the whole rest of the game
+ *             has been searched. Only touches the given board, so it
+ *             can search a predicted one off the main thread.
+ *
+ * Parameters: the board, our board index, the opponent's (-1 if we
+ *             don't know it) and the seconds the search can take
+ *
+ * Returns:    the board index to move to, or -1 if we can't move or
+ *             there are no points left that we could reach
+ **************************************/
+int GameSearch::search(BitBoard *board, int us, int them, double budget) {
+	double start = Util::getTime();
+	_deadline = start + budget;
+	_timeUp = false;
+	_bestMove = -1;
+	_stats.depth = 0;
+	_stats.nodes = 0;
+	_stats.time = 0.0;
+	_stats.value = 0.0;
+	_stats.complete = false;
+
+	for (int i = 0; i < BOARD_CELLS; i++) {
+		int x = i % MAP_WIDTH;
+		int y = i / MAP_WIDTH;
+		_ourValues[i] = Path::cellValue(x, y, board->points[i]);
+		_theirValues[i] = board->points[i];
+	}
+
+	// what's stored is only good for the points it was searched with
+	if (memcmp(_tablePoints, board->points, BOARD_CELLS) != 0) {
+		_table.clear();
+		memcpy(_tablePoints, board->points, BOARD_CELLS);
+	}
+	else {
+		_table.newSearch();
+	}
+
+	GameState root;
+	root.us = us;
+	root.them = them;
+	root.blocked = board->blocked | BitBoard::bitAt(us);
+	if (them != -1) {
+		root.blocked |= BitBoard::bitAt(them);
+	}
+	root.heading = -1;
+	root.value = 0.0;
+	root.hash = _zobrist.hashBlocked(root.blocked) ^ _zobrist.us[root.us] ^
+	            _zobrist.heading[0];
+	if (root.them != -1) {
+		root.hash ^= _zobrist.them[root.them];
+	}
+
+	// nothing to search for if no pellet can be reached from here
+	uint64_t reached = BitBoard::bitAt(us);
+	uint64_t frontier = reached;
+	while (frontier) {
+		frontier = BitBoard::neighbours(frontier) & ~root.blocked & ~reached;
+		reached |= frontier;
+	}
+	if (!(board->pellet & reached)) {
+		return -1;
+	}
+
+	for (int depth = 2; depth <= GAME_SEARCH_MAX_DEPTH; depth += 2) {
+		_cutOff = false;
+		int move = -1;
+		float value = _maxMove(&root, depth, -GAME_INFINITY, GAME_INFINITY, 
+		                       &move);
+		if (_timeUp) {
+			break;
+		}
+
+		_bestMove = move;
+		_stats.depth = depth;
+		_stats.value = value;
+		if (move == -1 || !_cutOff) {
+			// nothing deeper to see
+			_stats.complete = true;
+			break;
+		}
+	}
+	_stats.time = Util::getTime() - start;
+
+	LOG.write(LOG_MED, "game_search", 
+	          "depth: %d%s nodes: %ld time: %f value: %f",
+	          _stats.depth, _stats.complete ? " (complete)" : "",
+	          _stats.nodes, _stats.time, _stats.value);
+	_table.logStats();
+
+	return _bestMove;
+}
+
+/**************************************
+ * Definition: Makes a search running on another thread finish up
+ *             with the best move it has so far, or lets searches
+ *             run their full time again
+ *
+ * Parameters: true to abort, false to stop aborting
+ **************************************/
+void GameSearch::setAbort(bool abort) {
+	_aborted = abort;
+}
+
+/**************************************
+ * Definition: Returns how the last search went
+ **************************************/
+GameSearchStats GameSearch::getStats() {
+	return _stats;
+}
+
+/**************************************
+ * Definition: Returns the transposition table, to look at its
+ *             counters
+ **************************************/
+TranspositionTable* GameSearch::getTable() {
+	return &_table;
+}
+
+/**************************************
+ * Definition: Our turn: tries each of our moves and keeps the one
+ *             that does best against the opponent's best reply
+ *
+ * Parameters: the game so far, the plies left to search, the alpha
+ *             and beta bounds, and where to store the best move
+ *             (only at the root, NULL below it)
+ *
+ * Returns:    the value of the game with the best move
+ **************************************/
+float GameSearch::_maxMove(GameState *state, int depth, 
+                           float alpha, float beta, int *bestMove) {
+	_stats.nodes++;
+	if (_outOfTime()) {
+		return state->value;
+	}
+	if (depth == 0) {
+		_cutOff = true;
+		return state->value;
+	}
+
+	int first = -1;
+	TTEntry entry;
+	if (_table.probe(state->hash, &entry)) {
+		if (bestMove == NULL && (entry.depth >= depth || entry.complete)) {
+			float value = state->value + entry.value;
+			if (entry.bound == TT_EXACT ||
+			    (entry.bound == TT_LOWER && value >= beta) ||
+			    (entry.bound == TT_UPPER && value <= alpha)) {
+				if (!entry.complete) {
+					_cutOff = true;
+				}
+				return value;
+			}
+		}
+		first = entry.move;
+	}
+	if (bestMove != NULL && _bestMove != -1) {
+		first = _bestMove;
+	}
+
+	int targets[4];
+	int headings[4];
+	int numMoves = _moves(state->us, state->blocked, _ourValues, first,
+	                      targets, headings);
+	if (numMoves == 0) {
+		// we're stuck, so they keep moving if they can
+		if (state->them == -1 ||
+		    _moves(state->them, state->blocked, _theirValues, -1, 
+		           targets, headings) == 0) {
+			return state->value;
+		}
+		return _minMove(state, depth-1, alpha, beta);
+	}
+
+	// see if anything below this state gets cut off for depth
+	bool cutOff = _cutOff;
+	_cutOff = false;
+
+	float startAlpha = alpha;
+	float best = -GAME_INFINITY;
+	int move = -1;
+	for (int i = 0; i < numMoves; i++) {
+		GameState next = *state;
+		next.us = targets[i];
+		next.blocked |= BitBoard::bitAt(targets[i]);
+		next.value += _ourValues[targets[i]];
+		if (next.heading != -1 && next.heading != headings[i]) {
+			next.value -= GAME_TURN_PENALTY;
+		}
+		next.hash ^= _zobrist.blocked[targets[i]] ^
+		             _zobrist.us[state->us] ^ _zobrist.us[targets[i]] ^
+		             _zobrist.heading[next.heading == -1 ? 0 : next.heading] ^
+		             _zobrist.heading[headings[i]];
+		next.heading = headings[i];
+
+		float value = _minMove(&next, depth-1, alpha, beta);
+		if (value > best) {
+			best = value;
+			move = targets[i];
+		}
+		if (best > alpha) {
+			alpha = best;
+		}
+		if (alpha >= beta) {
+			break;
+		}
+	}
+
+	if (!_timeUp) {
+		int bound = TT_EXACT;
+		if (best <= startAlpha) {
+			bound = TT_UPPER;
+		}
+		else if (best >= beta) {
+			bound = TT_LOWER;
+		}
+		_table.store(state->hash, depth, best - state->value, bound, move, 
+		             !_cutOff);
+	}
+	_cutOff = _cutOff || cutOff;
+
+	if (bestMove != NULL) {
+		*bestMove = move;
+	}
+	return best;
+}
+
+/**************************************
+ * Definition: The opponent's turn: tries each of their moves and
+ *             keeps the one that does worst for us
+ *
+ * Parameters: the game so far, the plies left to search and the
+ *             alpha and beta bounds
+ *
+ * Returns:    the value of the game with their best move
+ **************************************/
+float GameSearch::_minMove(GameState *state, int depth, 
+                           float alpha, float beta) {
+	_stats.nodes++;
+	if (_outOfTime()) {
+		return state->value;
+	}
+	if (depth == 0) {
+		_cutOff = true;
+		return state->value;
+	}
+	if (state->them == -1) {
+		// we don't know where they are, so they never get in our way
+		return _maxMove(state, depth-1, alpha, beta, NULL);
+	}
+
+	uint64_t hash = state->hash ^ _zobrist.theirTurn;
+	int first = -1;
+	TTEntry entry;
+	if (_table.probe(hash, &entry)) {
+		if (entry.depth >= depth || entry.complete) {
+			float value = state->value + entry.value;
+			if (entry.bound == TT_EXACT ||
+			    (entry.bound == TT_LOWER && value >= beta) ||
+			    (entry.bound == TT_UPPER && value <= alpha)) {
+				if (!entry.complete) {
+					_cutOff = true;
+				}
+				return value;
+			}
+		}
+		first = entry.move;
+	}
+
+	int targets[4];
+	int headings[4];
+	int numMoves = _moves(state->them, state->blocked, _theirValues, first,
+	                      targets, headings);
+	if (numMoves == 0) {
+		// they're stuck, so we keep moving if we can
+		if (_moves(state->us, state->blocked, _ourValues, -1, 
+		           targets, headings) == 0) {
+			return state->value;
+		}
+		return _maxMove(state, depth-1, alpha, beta, NULL);
+	}
+
+	bool cutOff = _cutOff;
+	_cutOff = false;
+
+	float startBeta = beta;
+	float best = GAME_INFINITY;
+	int move = -1;
+	for (int i = 0; i < numMoves; i++) {
+		GameState next = *state;
+		next.them = targets[i];
+		next.blocked |= BitBoard::bitAt(targets[i]);
+		next.value -= _theirValues[targets[i]];
+		next.hash ^= _zobrist.blocked[targets[i]] ^
+		             _zobrist.them[state->them] ^ _zobrist.them[targets[i]];
+
+		float value = _maxMove(&next, depth-1, alpha, beta, NULL);
+		if (value < best) {
+			best = value;
+			move = targets[i];
+		}
+		if (best < beta) {
+			beta = best;
+		}
+		if (alpha >= beta) {
+			break;
+		}
+	}
+
+	if (!_timeUp) {
+		int bound = TT_EXACT;
+		if (best >= startBeta) {
+			bound = TT_LOWER;
+		}
+		else if (best <= alpha) {
+			bound = TT_UPPER;
+		}
+		_table.store(hash, depth, best - state->value, bound, move, 
+		             !_cutOff);
+	}
+	_cutOff = _cutOff || cutOff;
+
+	return best;
+}
+
+/**************************************
+ * Definition: Finds the moves a robot can make from a cell, ordered
+ *             so the search cuts off sooner: the given first move
+ *             (if it can be made), then the richest cells
+ *
+ * Parameters: the robot's board index, the blocked cells, what each
+ *             cell is worth to the robot, a move to try first (or -1),
+ *             and arrays of 4 to store the moves' board indices and
+ *             headings in
+ *
+ * Returns:    the number of moves
+ **************************************/
+int GameSearch::_moves(int index, uint64_t blocked, float *values, int first,
+                       int *targets, int *headings) {
+	uint64_t bit = BitBoard::bitAt(index);
+	uint64_t open = ~blocked & BOARD_ALL;
+
+	uint64_t moves[4] = {bit << MAP_WIDTH, bit >> MAP_WIDTH,
+	                     (bit & ~BOARD_FIRST_COLUMN) >> 1,
+	                     (bit & ~BOARD_LAST_COLUMN) << 1};
+	int offsets[4] = {MAP_WIDTH, -MAP_WIDTH, -1, 1};
+	int moveHeadings[4] = {DIR_NORTH, DIR_SOUTH, DIR_EAST, DIR_WEST};
+
+	int numMoves = 0;
+	for (int i = 0; i < 4; i++) {
+		if (!(moves[i] & open)) {
+			continue;
+		}
+
+		int target = index + offsets[i];
+		float value = target == first ? GAME_INFINITY : values[target];
+
+		// insertion sort, there are at most 4
+		int j = numMoves;
+		while (j > 0) {
+			int prev = targets[j-1];
+			float prevValue = prev == first ? GAME_INFINITY : values[prev];
+			if (prevValue >= value) {
+				break;
+			}
+			targets[j] = targets[j-1];
+			headings[j] = headings[j-1];
+			j--;
+		}
+		targets[j] = target;
+		headings[j] = moveHeadings[i];
+		numMoves++;
+	}
+	return numMoves;
+}
+
+/**************************************
+ * Definition: Determines if the search has run out of time or been
+ *             aborted, looking only every so many nodes. The first
+ *             round always finishes so there's a move to make.
+ **************************************/
+bool GameSearch::_outOfTime() {
+	if (_timeUp) {
+		return true;
+	}
+	if (_bestMove == -1 || _stats.nodes % GAME_SEARCH_CHECK_NODES != 0) {
+		return false;
+	}
+	_timeUp = _aborted || Util::getTime() > _deadline;
+	return _timeUp;
+}
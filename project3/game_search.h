@@ -0,0 +1,90 @@
+/**
+ * game_search.h
+ *
+ * @brief
+ *      This class picks our next cell by searching the game as two
+ *      players taking turns to move, us trying to get the most points
+ *      more than the opponent and them trying to get the most points
+ *      more than us. It's a minimax search with alpha-beta pruning,
+ *      deepened one round at a time until its time runs out, with the
+ *      best move of the last round and the richest cells tried first.
+ *
+ *      The game is played on the bit board (see BitBoard): any cell
+ *      either robot has been in is blocked from then on, like the
+ *      occupied cells on the map. States are hashed as they're played
+ *      (see Zobrist), and ones that have been searched before are
+ *      looked up in a transposition table instead.
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#ifndef CS1567_GAMESEARCH_H
+#define CS1567_GAMESEARCH_H
+
+#include "map.h"
+#include "bitboard.h"
+#include "zobrist.h"
+#include "transposition_table.h"
+
+#define GAME_SEARCH_BUDGET 0.25     // seconds per decision
+#define GAME_SEARCH_MAX_DEPTH 40    // plies, a move each is two
+#define GAME_SEARCH_CHECK_NODES 1024 // nodes between looks at the clock
+#define GAME_TURN_PENALTY 1.0       // points, like a path's direction change
+
+typedef struct {
+	int us;             // board index of our cell
+	int them;           // board index of theirs, -1 if we don't know it
+	uint64_t blocked;   // posts and every cell a robot has been in
+	int heading;        // of our last move, -1 before the first
+	float value;        // our points minus theirs so far
+	uint64_t hash;      // of everything but value and whose turn it is
+} GameState;
+
+typedef struct {
+	int depth;          // plies in the deepest round that finished
+	long nodes;
+	double time;        // seconds
+	float value;        // of the best move, at that depth
+	bool complete;      // if it saw the end of the game
+} GameSearchStats;
+
+class GameSearch {
+public:
+	GameSearch(Map *map);
+	~GameSearch();
+	Cell* nextCell(double budget);
+	int search(BitBoard *board, int us, int them, double budget);
+	void setAbort(bool abort);
+	GameSearchStats getStats();
+	TranspositionTable* getTable();
+private:
+	Map *_map;
+	BitBoard *_board;
+
+	float _ourValues[BOARD_CELLS];    // what a cell is worth to us
+	float _theirValues[BOARD_CELLS];  // and to them
+
+	double _deadline;
+	bool _timeUp;
+	volatile bool _aborted;
+	bool _cutOff;       // if the last round stopped anywhere for depth
+	int _bestMove;      // board index of the best first move so far
+	GameSearchStats _stats;
+
+	Zobrist _zobrist;
+	TranspositionTable _table;
+	uint8_t _tablePoints[BOARD_CELLS]; // the points _table was filled with
+
+	float _maxMove(GameState *state, int depth, float alpha, float beta,
+	               int *bestMove);
+	float _minMove(GameState *state, int depth, float alpha, float beta);
+	int _moves(int index, uint64_t blocked, float *values, int first,
+	           int *targets, int *headings);
+	bool _outOfTime();
+};
+
+#endif
@@ -0,0 +1,152 @@
+/**
+ * link_health.cpp
+ *
+ * @brief
+ *      This class keeps track of how well the link to the robot is
+ *      doing: a histogram of how long each interface update takes, how
+ *      many fail in a row, and an overall link quality for the control
+ *      loops to slow down on. It also works out how long to back off
+ *      after a failure (exponential, with jitter, so a lossy link isn't
+ *      hammered with retries).
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#include "link_health.h"
+#include "logger.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+LinkHealth::LinkHealth() {
+    _seed = (unsigned int)time(NULL);
+    reset();
+}
+
+LinkHealth::~LinkHealth() {}
+
+/**************************************
+ * Definition: Forgets every update, and starts the link off as good
+ **************************************/
+void LinkHealth::reset() {
+    memset(&_stats, 0, sizeof(LinkStats));
+    _successRate = 1.0;
+    _latency = 0.0;
+}
+
+/**************************************
+ * Definition: Records an interface update
+ *
+ * Parameters: how long it took in seconds and whether it succeeded
+ **************************************/
+void LinkHealth::record(double latency, bool success) {
+    _stats.updates++;
+    _successRate += LINK_QUALITY_WEIGHT * ((success ? 1.0 : 0.0) - _successRate);
+
+    if (!success) {
+        _stats.failures++;
+        _stats.streak++;
+        if (_stats.streak > _stats.longestStreak) {
+            _stats.longestStreak = _stats.streak;
+        }
+        return;
+    }
+
+    _stats.streak = 0;
+    _stats.totalLatency += latency;
+    if (latency > _stats.maxLatency) {
+        _stats.maxLatency = latency;
+    }
+    _latency += LINK_QUALITY_WEIGHT * (latency - _latency);
+
+    int bucket = 0;
+    while (bucket < LINK_NUM_BUCKETS && latency > LINK_BUCKETS[bucket]) {
+        bucket++;
+    }
+    _stats.histogram[bucket]++;
+}
+
+/**************************************
+ * Definition: Returns how long to wait before retrying after the
+ *             current streak of failures. Doubles with each failure
+ *             up to LINK_BACKOFF_MAX, and is jittered to somewhere
+ *             between half and all of that.
+ *
+ * Returns:    the delay in seconds, or 0 if the last update succeeded
+ **************************************/
+double LinkHealth::getBackoff() {
+    if (_stats.streak == 0) {
+        return 0.0;
+    }
+
+    double backoff = LINK_BACKOFF_MIN;
+    for (int i = 1; i < _stats.streak && backoff < LINK_BACKOFF_MAX; i++) {
+        backoff *= 2;
+    }
+    if (backoff > LINK_BACKOFF_MAX) {
+        backoff = LINK_BACKOFF_MAX;
+    }
+
+    double jitter = (double)rand_r(&_seed) / RAND_MAX;
+    return backoff * (0.5 + 0.5 * jitter);
+}
+
+/**************************************
+ * Definition: Returns how good the link is lately, from the share of
+ *             updates that succeed and how slow the successful ones
+ *             are compared to LINK_GOOD_LATENCY
+ *
+ * Returns:    a quality from 0 (nothing getting through) to 1
+ **************************************/
+float LinkHealth::getQuality() {
+    float quality = _successRate;
+    if (_latency > LINK_GOOD_LATENCY) {
+        quality *= LINK_GOOD_LATENCY / _latency;
+    }
+    return quality;
+}
+
+/**************************************
+ * Definition: Returns how many updates in a row have failed
+ **************************************/
+int LinkHealth::getStreak() {
+    return _stats.streak;
+}
+
+LinkStats* LinkHealth::getStats() {
+    return &_stats;
+}
+
+/**************************************
+ * Definition: Logs the failure counts and latency histogram
+ *
+ * Parameters: a name to log the stats under
+ **************************************/
+void LinkHealth::logStats(std::string name) {
+    if (_stats.updates == 0) {
+        return;
+    }
+    int successes = _stats.updates - _stats.failures;
+    LOG.write(LOG_MED, "link_health",
+              "%s: %d updates, %d failed (longest streak %d), "
+              "latency mean/max: %f/%f s, quality: %f",
+              name.c_str(), _stats.updates, _stats.failures,
+              _stats.longestStreak, 
+              successes > 0 ? _stats.totalLatency / successes : 0.0,
+              _stats.maxLatency, getQuality());
+    for (int i = 0; i <= LINK_NUM_BUCKETS; i++) {
+        if (i < LINK_NUM_BUCKETS) {
+            LOG.write(LOG_MED, "link_health", "%s: <= %f s: %d",
+                      name.c_str(), LINK_BUCKETS[i], _stats.histogram[i]);
+        }
+        else {
+            LOG.write(LOG_MED, "link_health", "%s: > %f s: %d",
+                      name.c_str(), LINK_BUCKETS[i-1], _stats.histogram[i]);
+        }
+    }
+}
@@ -0,0 +1,69 @@
+/**
+ * link_health.h
+ *
+ * @brief
+ *      This class keeps track of how well the link to the robot is
+ *      doing: a histogram of how long each interface update takes, how
+ *      many fail in a row, and an overall link quality for the control
+ *      loops to slow down on. It also works out how long to back off
+ *      after a failure (exponential, with jitter, so a lossy link isn't
+ *      hammered with retries).
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#ifndef CS1567_LINKHEALTH_H
+#define CS1567_LINKHEALTH_H
+
+#include <string>
+
+// upper bounds of the latency histogram buckets (the last one
+// catches everything slower)
+#define LINK_NUM_BUCKETS 8
+const double LINK_BUCKETS[LINK_NUM_BUCKETS] = {
+    0.005, 0.01, 0.02, 0.05, 0.1, 0.2, 0.5, 1.0 // seconds
+};
+
+// backoff after the first failure, doubling with each one after that
+#define LINK_BACKOFF_MIN 0.01 // seconds
+#define LINK_BACKOFF_MAX 0.5 // seconds
+
+// how quickly the quality follows new updates (0-1, higher is faster)
+#define LINK_QUALITY_WEIGHT 0.1
+
+// updates faster than this don't count against the link quality
+#define LINK_GOOD_LATENCY 0.05 // seconds
+
+typedef struct {
+    int updates;
+    int failures;
+    int streak;             // failures in a row right now
+    int longestStreak;
+    double totalLatency;    // seconds, over successful updates
+    double maxLatency;
+    int histogram[LINK_NUM_BUCKETS + 1];
+} LinkStats;
+
+class LinkHealth {
+public:
+    LinkHealth();
+    ~LinkHealth();
+    void reset();
+    void record(double latency, bool success);
+    double getBackoff();
+    float getQuality();
+    int getStreak();
+    LinkStats* getStats();
+    void logStats(std::string name);
+private:
+    LinkStats _stats;
+    float _successRate;     // moving average of successful updates
+    float _latency;         // moving average latency of successful updates
+    unsigned int _seed;
+};
+
+#endif
@@ -23,7 +23,9 @@
  * Definition: Creates a new logger with a default importance of low
  **************************************/
 Logger::Logger()
-: _files(), _importanceLevel(LOG_LOW) {}
+: _files(), _importanceLevel(LOG_LOW) {
+    pthread_mutex_init(&_filesMutex, NULL);
+}
 
 Logger::~Logger() {
     // loop through the map and close all files
@@ -31,6 +33,7 @@ Logger::~Logger() {
     for (iter = _files.begin(); iter != _files.end(); iter++) {
         fclose(iter->second);
     }
+    pthread_mutex_destroy(&_filesMutex);
 }
 /**************************************
  * Definition: Sets the importance level of the logger to some new value.
@@ -128,12 +131,12 @@ void Logger::printfScreen(int level, std::string filename, const char *formatStr
  * Parameters: a string containing a filename,
  **************************************/
 void Logger::flushFile(std::string filename) {
-    FILE *file;
+    pthread_mutex_lock(&_filesMutex);
     std::map<std::string, FILE*>::iterator iter = _files.find(filename);
     if (iter != _files.end()) {
-        file = _files[filename];
-        fflush(file);
+        fflush(iter->second);
     }
+    pthread_mutex_unlock(&_filesMutex);
 }
 
 /**************************************
@@ -175,6 +178,7 @@ void Logger::_vprintfFile(int level, std::string filename, const char *formatStr
         // warrant logging it
 
         // is the file already open?
+        pthread_mutex_lock(&_filesMutex);
         FILE *file;
         std::map<std::string, FILE*>::iterator iter = _files.find(filename);
         if (iter == _files.end()) {
@@ -188,6 +192,7 @@ void Logger::_vprintfFile(int level, std::string filename, const char *formatStr
             if (mkdir(filePath.c_str(), S_IREAD | S_IWRITE | S_IEXEC) != 0 &&
                 errno != EEXIST) {
                 fprintf(stderr, "Unable to create directory!\n");
+                pthread_mutex_unlock(&_filesMutex);
                 return;
             }
 
@@ -202,6 +207,7 @@ void Logger::_vprintfFile(int level, std::string filename, const char *formatStr
             if (mkdir(filePath.c_str(), S_IREAD | S_IWRITE | S_IEXEC) != 0 &&
                 errno != EEXIST) {
                 fprintf(stderr, "Unable to create directory!\n");
+                pthread_mutex_unlock(&_filesMutex);
                 return;
             }
 
@@ -229,6 +235,7 @@ void Logger::_vprintfFile(int level, std::string filename, const char *formatStr
             file = fopen(filePath.c_str(), "w");
             if (file == NULL) {
                 fprintf(stderr, "Unable to write to output file!\n");
+                pthread_mutex_unlock(&_filesMutex);
                 return;
             }
 
@@ -239,6 +246,7 @@ void Logger::_vprintfFile(int level, std::string filename, const char *formatStr
             // the file already exists, so let's grab it
             file = _files[filename];
         }
+        pthread_mutex_unlock(&_filesMutex);
 
         // print the message out to file and flush it right away
         vfprintf(file, formatString, listPointer);
@@ -19,6 +19,7 @@
 #include <map>
 #include <string>
 #include <cstdarg>
+#include <pthread.h>
 
 // some default importance levels
 #define LOG_OFF 99
@@ -54,6 +55,8 @@ private:
 
     int _importanceLevel;
     std::map<std::string, FILE*> _files;
+    // the sensor thread logs too, so guard the map of files
+    pthread_mutex_t _filesMutex;
 };
 
 #endif
@@ -1,14 +1,44 @@
 #include "map.h"
+#include "sensor_thread.h"
 #include "logger.h"
 
 Map::Map(RobotInterface *robotInterface, int startingX, int startingY) {
 	_robotInterface = robotInterface;
 	_score1 = 0;
 	_score2 = 0;
-	_loadMap();
+	_opponentCell = NULL;
+
+	map_obj_t *map;
+	{
+		InterfaceLock lock;
+		map = _robotInterface->getMap(&_score1, &_score2);
+	}
+	_loadMap(map);
+	_start(startingX, startingY);
+}
+
+/**************************************
+ * Definition: Builds the map from a given list of map objects
+ *             instead of the game server's, for replays and tests.
+ *             It can't be updated.
+ *
+ * Parameters: the map object list and the cell we start in
+ **************************************/
+Map::Map(map_obj_t *map, int startingX, int startingY) {
+	_robotInterface = NULL;
+	_score1 = 0;
+	_score2 = 0;
+	_opponentCell = NULL;
+	_loadMap(map);
+	_start(startingX, startingY);
+}
+
+void Map::_start(int startingX, int startingY) {
 	// we are the robot at this cell
 	_claimRobotAt(startingX, startingY);
 	_curCell = cells[startingX][startingY];
+	// which cells are blocked depends on which robot we are
+	_syncBoard();
 	LOG.write(LOG_LOW, "map", "starting cell: %d, %d",
 			  startingX, startingY);
 }
@@ -21,25 +51,49 @@ Map::~Map() {
 	}
 }
 
+/**************************************
+ * Definition: Gets the map from the game server and updates only
+ *             the cells that changed (and the openings next to any
+ *             that became blocked or unblocked), then tells every
+ *             listener what changed
+ **************************************/
 void Map::update() {
-	map_obj_t *map = _robotInterface->getMap(&_score1, &_score2);
+	if (_robotInterface == NULL) {
+		return;
+	}
+
+	map_obj_t *map;
+	{
+		InterfaceLock lock;
+		map = _robotInterface->getMap(&_score1, &_score2);
+	}
+
+	MapChanges changes;
+	_startChanges(&changes);
+	Cell *opponentCell = _opponentCell;
 
 	// iterate through the linked list map
-	// and update each cell
+	// and update each cell that changed
 	while (map != NULL) {
 		int x = map->x;
 		int y = map->y;
 
-		cells[x][y]->update(map);
+		if (cells[x][y]->update(map)) {
+			_applyChange(cells[x][y], &changes);
+		}
 		
-		if(map->type == MAP_OBJ_ROBOT_1 && cells[x][y]->robot==1){
+		// the opponent is whichever robot we aren't
+		if ((map->type == MAP_OBJ_ROBOT_1 && Cell::robot == 2) ||
+		    (map->type == MAP_OBJ_ROBOT_2 && Cell::robot == 1)) {
 			_setOpponentLoc(x,y);
 		}
 
 		map = map->next;
 	}
 
-	_adjustOpenings();
+	changes.opponentMoved = _opponentCell != opponentCell;
+	changes.opponentCell = _opponentCell;
+	_publish(&changes);
 }
 
 int Map::getRobot1Score() {
@@ -55,14 +109,7 @@ Cell* Map::getCurrentCell() {
 }
 
 bool Map::canOccupy(int x, int y) {
-	Cell *moveCell = NULL;
-	moveCell = cellAt(x, y);
-	LOG.printfScreen(LOG_LOW, "path", "canOccupy (%d, %d) = %d\n", x,y, moveCell);
-	if (moveCell == NULL) {
-		return false;
-	}
-	LOG.printfScreen(LOG_LOW, "path", "moveCell->blocked = %d\n", moveCell->isBlocked());
-	return !moveCell->isBlocked();
+	return _board.canEnter(x, y);
 }
 
 Cell* Map::cellAt(int x, int y) {
@@ -76,6 +123,10 @@ Cell* Map::cellAt(int x, int y) {
 bool Map::occupyCell(int x, int y) {
 	if (cells[x][y]->occupy(_robotInterface)) {
 		_curCell = cells[x][y];
+		MapChanges changes;
+		_startChanges(&changes);
+		_applyChange(_curCell, &changes);
+		_publish(&changes);
 		return true;
 	}
 	return false;
@@ -89,18 +140,54 @@ Cell* Map::getOpponentCell(){
 	return _opponentCell;
 }
 
+/**************************************
+ * Definition: Returns the map as bit masks, for the planners
+ **************************************/
+BitBoard* Map::getBoard() {
+	return &_board;
+}
+
+/**************************************
+ * Definition: Has the listener told about every change to the map
+ *             from now on, until it unsubscribes
+ *
+ * Parameters: the listener
+ **************************************/
+void Map::subscribe(MapListener *listener) {
+	_listeners.push_back(listener);
+}
+
+/**************************************
+ * Definition: Stops telling the listener about changes
+ *
+ * Parameters: the listener
+ **************************************/
+void Map::unsubscribe(MapListener *listener) {
+	for (size_t i = 0; i < _listeners.size(); i++) {
+		if (_listeners[i] == listener) {
+			_listeners.erase(_listeners.begin() + i);
+			return;
+		}
+	}
+}
+
 bool Map::reserveCell(int x, int y) {
-	return cells[x][y]->reserve(_robotInterface);
+	if (cells[x][y]->reserve(_robotInterface)) {
+		MapChanges changes;
+		_startChanges(&changes);
+		_applyChange(cells[x][y], &changes);
+		_publish(&changes);
+		return true;
+	}
+	return false;
 }
 
 void Map::_claimRobotAt(int x, int y) {
 	cells[x][y]->claimRobot();
 }
 
-void Map::_loadMap() {
-	// load the map to start with and fill in our
-	// cell matrix
-	map_obj_t *map = _robotInterface->getMap(&_score1, &_score2);
+void Map::_loadMap(map_obj_t *map) {
+	// fill in our cell matrix from the map to start with
 
 	// iterate through the linked list map
 	while (map != NULL) {
@@ -114,7 +201,7 @@ void Map::_loadMap() {
 		map = map->next;
 	}
 
-	_adjustOpenings();
+	_adjustOpenings(BOARD_ALL);
 
 	// Let's see what we have...
     for (int x = 0; x < MAP_WIDTH; x++) {
@@ -136,11 +223,93 @@ void Map::_loadMap() {
     }
 }
 
-void Map::_adjustOpenings(){
+/**************************************
+ * Definition: Copies every cell onto the bit board
+ **************************************/
+void Map::_syncBoard() {
+	for (int x = 0; x < MAP_WIDTH; x++) {
+		for (int y = 0; y < MAP_HEIGHT; y++) {
+			_board.setCell(cells[x][y]);
+		}
+	}
+}
+
+/**************************************
+ * Definition: Starts an empty set of changes
+ **************************************/
+void Map::_startChanges(MapChanges *changes) {
+	changes->changed = 0;
+	changes->blocked = 0;
+	changes->points = 0;
+	changes->opponentMoved = false;
+	changes->opponentCell = _opponentCell;
+}
+
+/**************************************
+ * Definition: Copies a changed cell onto the bit board and notes
+ *             what about it changed
+ *
+ * Parameters: the cell and the changes to note it in
+ **************************************/
+void Map::_applyChange(Cell *cell, MapChanges *changes) {
+	int index = BitBoard::indexOf(cell->x, cell->y);
+	uint64_t bit = BitBoard::bitAt(index);
+	uint64_t blocked = _board.blocked & bit;
+	int points = _board.points[index];
+
+	_board.setCell(cell);
+
+	changes->changed |= bit;
+	if ((_board.blocked & bit) != blocked) {
+		changes->blocked |= bit;
+	}
+	if (_board.points[index] != points) {
+		changes->points |= bit;
+	}
+}
+
+/**************************************
+ * Definition: Fixes the openings next to cells that became blocked
+ *             or unblocked and tells every listener about the
+ *             changes, if there were any
+ *
+ * Parameters: the changes
+ **************************************/
+void Map::_publish(MapChanges *changes) {
+	if (changes->changed == 0 && !changes->opponentMoved) {
+		return;
+	}
+
+	if (changes->blocked != 0) {
+		_adjustOpenings(changes->blocked);
+	}
+
+	LOG.write(LOG_LOW, "map", "changed cells: %llx blocked: %llx "
+	          "points: %llx opponent moved: %d", 
+	          (unsigned long long)changes->changed, 
+	          (unsigned long long)changes->blocked, 
+	          (unsigned long long)changes->points, changes->opponentMoved);
+
+	for (size_t i = 0; i < _listeners.size(); i++) {
+		_listeners[i]->mapChanged(changes);
+	}
+}
+
+/**************************************
+ * Definition: Works out the openings of every cell next to (or one
+ *             of) the given cells from which of its neighbours are
+ *             blocked
+ *
+ * Parameters: the cells that changed, as a bit board mask
+ **************************************/
+void Map::_adjustOpenings(uint64_t changed) {
+	uint64_t adjust = changed | BitBoard::neighbours(changed);
 	for (int x = 0; x < MAP_WIDTH; x++) {
 	    for (int y = 0; y < MAP_HEIGHT; y++) {
-		    //if (cells[x][y]->isBlocked())
-		    //	continue;
+		    if (!(adjust & BitBoard::bitAt(BitBoard::indexOf(x, y)))) {
+		    	continue;
+		    }
+		    cells[x][y]->clearOpenings();
 		      
 		    if (x+1 < MAP_WIDTH) {
 		        if (!cells[x+1][y]->isBlocked()) {
@@ -3,19 +3,36 @@
 
 #include <robot_if++.h>
 #include "cell.h"
+#include "bitboard.h"
 
-#define MAP_WIDTH 7
-#define MAP_HEIGHT 5
+#include <vector>
 
 #define DIR_NORTH 1
 #define DIR_EAST 2
 #define DIR_SOUTH 4
 #define DIR_WEST 8
 
+// what one update of the map changed, as bit board masks
+typedef struct {
+	uint64_t changed;   // cells whose state changed at all
+	uint64_t blocked;   // cells that became blocked or unblocked
+	uint64_t points;    // cells whose points changed
+	bool opponentMoved;
+	Cell *opponentCell; // where the opponent is now, NULL if unknown
+} MapChanges;
+
+// anything that keeps state derived from the map, to be told when
+// the map changes (see Map::subscribe)
+class MapListener {
+public:
+	virtual ~MapListener() {}
+	virtual void mapChanged(MapChanges *changes) = 0;
+};
 
 class Map {
 public:
 	Map(RobotInterface *robotInterface, int startingX, int startingY);
+	Map(map_obj_t *map, int startingX, int startingY);
 	~Map();
 	void update();
 	int getRobot1Score();
@@ -27,14 +44,23 @@ public:
 	bool reserveCell(int x, int y);
 	
 	Cell* getOpponentCell();
+	BitBoard* getBoard();
+
+	void subscribe(MapListener *listener);
+	void unsubscribe(MapListener *listener);
 
 	Cell *cells[MAP_WIDTH][MAP_HEIGHT];
 private:
 	void _claimRobotAt(int x, int y);
-	void _loadMap();
+	void _loadMap(map_obj_t *map);
+	void _start(int startingX, int startingY);
         
 	void _setOpponentLoc(int x, int y);
-    void _adjustOpenings();
+	void _adjustOpenings(uint64_t changed);
+	void _syncBoard();
+	void _startChanges(MapChanges *changes);
+	void _applyChange(Cell *cell, MapChanges *changes);
+	void _publish(MapChanges *changes);
 
 	RobotInterface *_robotInterface;
 
@@ -43,6 +69,10 @@ private:
 
 	Cell *_curCell;
 	Cell *_opponentCell;
+
+	BitBoard _board;    // kept in sync with cells
+
+	std::vector<MapListener *> _listeners;
 };
 
 #endif
@@ -1,29 +1,79 @@
 #include "map_strategy.h"
+#include "constants.h"
+#include "utilities.h"
 #include "logger.h"
 
+#include <string.h>
+
 MapStrategy::MapStrategy(Map *map) {
 	_map = map;
+	_board = map->getBoard();
+	_gameSearch = new GameSearch(map);
+	_planner = new Planner(map);
+	_travel = new TravelTable(map);
+	if (USE_GAME_SEARCH && USE_BACKGROUND_PLANNER) {
+		_planner->start();
+	}
+	_threads = PATH_THREADS;
+	_nodes = 0;
+	_deadline = 0.0;
+	_timeUp = false;
+	memset(&_pathStats, 0, sizeof(PathSearchStats));
+	for (int i = 0; i < PATH_THREADS; i++) {
+		_workers[i].strategy = this;
+		_workers[i].nodes = 0;
+	}
 }
 
 MapStrategy::~MapStrategy() {
-	clearPaths();
+	_planner->logStats();
+	delete _planner;
+	delete _travel;
+	delete _gameSearch;
 }
 
-Cell* MapStrategy::nextCell() {
+/********************************************
+ * Definition: Picks the next cell to move to and reserves it. Takes
+ *             about the given time whatever the board looks like:
+ *             the searches stop where they've got to when it's up.
+ *
+ * Parameters: the seconds it can take and the way the robot is
+ *             facing (DIR_NORTH, ...), or -1 if it isn't known
+ *
+ * Returns:    the cell, or NULL if there's nothing left worth moving
+ *             for
+ *******************************************/
+Cell* MapStrategy::nextCell(double budget, int heading) {
+	double deadline = Util::getTime() + budget;
 	_map->update();
 
-	Path *path = getBestPath(PATH_LENGTH);
-	//LOG.printfScreen(LOG_LOW, "path", "Path # = %d\n", path);
-	if (path == NULL || path->getValue() == 0) {
-		path = getBestPath(10);
-		//LOG.printfScreen(LOG_LOW, "path", "Trying bigger path");
-		if (path == NULL || path->getValue() == 0) {
-			return NULL;
+	if (USE_GAME_SEARCH) {
+		// use the plan made while we were driving here, if the map
+		// hasn't changed under it
+		Cell *nextCell = _planner->getPlan();
+		if (nextCell == NULL) {
+			nextCell = _gameSearch->nextCell(deadline - Util::getTime());
+		}
+		if (nextCell != NULL) {
+			_map->reserveCell(nextCell->x, nextCell->y);
+			return nextCell;
 		}
 	}
-	
-	Cell *nextCell = path->getFirstCell();
-	//LOG.write(LOG_LOW, "nextCell", "We have a path.");
+
+	Cell *nextCell = NULL;
+	Path *path = searchPaths(deadline - Util::getTime());
+	if (path != NULL) {
+		nextCell = path->getFirstCell();
+	}
+	else {
+		// nothing worth points within reach of the paths searched,
+		// so head for whatever's worth the most for the time it takes
+		nextCell = _towardsBestTarget(heading);
+	}
+	if (nextCell == NULL) {
+		return NULL;
+	}
+
 	//LOG.write(LOG_LOW, "nextCell", "Cell (x, y): (%d, %d)",
 	//          nextCell->x, nextCell->y);
 	_map->reserveCell(nextCell->x, nextCell->y);
@@ -31,6 +81,46 @@ Cell* MapStrategy::nextCell() {
 	return nextCell;
 }
 
+/********************************************
+ * Definition: Starts planning the move after the given cell in the
+ *             background (see Planner), so it's ready by the time
+ *             nextCell is called from there
+ *
+ * Parameters: the cell we're driving into
+ *******************************************/
+void MapStrategy::planFrom(Cell *cell) {
+	if (USE_GAME_SEARCH && USE_BACKGROUND_PLANNER) {
+		_planner->planFrom(cell);
+	}
+}
+
+/********************************************
+ * Definition: Finds the cell worth the most points per second of
+ *             travel from where we are (see TravelTable), counting
+ *             the turns it takes from the way we're facing
+ *
+ * Parameters: the way the robot is facing, or -1 if it isn't known
+ *
+ * Returns:    the first cell on the quickest way there, or NULL if
+ *             nothing worth points can be reached
+ *******************************************/
+Cell* MapStrategy::_towardsBestTarget(int heading) {
+	Cell *curCell = _map->getCurrentCell();
+	int from = BitBoard::indexOf(curCell->x, curCell->y);
+	int target = _travel->getBestTarget(from, heading);
+	if (target == -1) {
+		return NULL;
+	}
+	int next = _travel->getFirstMove(from, heading, target);
+	if (next == -1) {
+		return NULL;
+	}
+	LOG.write(LOG_LOW, "nextCell", "heading for (%d, %d), %f s away", 
+	          target % MAP_WIDTH, target / MAP_WIDTH, 
+	          _travel->getTime(from, heading, target));
+	return _map->cells[next % MAP_WIDTH][next / MAP_WIDTH];
+}
+
 /*
 // TODO: use MiniMax algorithm
 Cell* MapStrategy::nextCell() {
@@ -118,78 +208,327 @@ Cell* MapStrategy::nextCell() {
 */
 
 /********************************************
- * Definition:
- * 
+ * Definition: Searches every path of the given length from the
+ *             current cell and keeps the one worth the most (see
+ *             Path::getValue).
+ *
+ *             The search is a depth first walk over a path stack
+ *             that carries its score down as it's extended (see
+ *             Path::extendScore), so nothing is allocated and
+ *             nothing is rescored however deep it goes. Long
+ *             searches are split by first move across threads, which
+ *             share the best value found so far to cut off paths
+ *             that can't beat it.
+ *
+ * Parameters: the number of moves in the path
+ *
+ * Returns:    the best path, which is only good until the next
+ *             search, or NULL if no path is worth anything
  *******************************************/
 Path* MapStrategy::getBestPath(int length) {
-	Path *bestPath = NULL;
-	Path *curPath = new Path(_map->getCurrentCell());
-	//LOG.printfScreen(LOG_LOW, "path", "creating paths\n");
-	createPaths(curPath, length);
-	float bestPathVal = 0.0;
-	int bestPathIndex = -1;
-	for (int i = 0; i < _pathList.size(); i++) {
-		float pathVal = _pathList[i]->getValue();
-		if (pathVal > bestPathVal) {
-	//		LOG.printfScreen(LOG_LOW, "path", "found new path -- value = %f\n", pathVal);
-			bestPathVal = pathVal;
-			bestPathIndex = i;
+	return _getBestPath(length, 0.0);
+}
+
+/********************************************
+ * Definition: Searches paths one move longer at a time, until the
+ *             given time runs out or they're as long as a path can
+ *             be. There's always a best path so far to return: a
+ *             length cut short by the clock is thrown away, and at
+ *             least one move is always searched all the way.
+ *
+ * Parameters: the seconds the search can take
+ *
+ * Returns:    the best path of the longest length searched all the
+ *             way that had one worth points, or NULL if none did
+ *******************************************/
+Path* MapStrategy::searchPaths(double budget) {
+	double start = Util::getTime();
+	double deadline = start + budget;
+	memset(&_pathStats, 0, sizeof(PathSearchStats));
+
+	Path *best = NULL;
+	for (int length = 1; length < MAX_PATH_LENGTH; length++) {
+		Path *path = _getBestPath(length, deadline);
+		_pathStats.nodes += _nodes;
+		if (_timeUp) {
+			break;
+		}
+
+		// no path this long may be worth points (or exist at all, in
+		// a dead end) while a shorter one was
+		_pathStats.depth = length;
+		if (path != NULL) {
+			_anytimePath = *path;
+			_pathStats.value = _anytimePath.getValue();
+			best = &_anytimePath;
+		}
+		if (Util::getTime() > deadline) {
+			break;
 		}
 	}
-	
-	if (bestPathIndex != -1) {
-		bestPath = _pathList[bestPathIndex];
-		_pathList.erase(_pathList.begin()+bestPathIndex);
+
+	_pathStats.time = Util::getTime() - start;
+	if (_pathStats.time > 0.0) {
+		_pathStats.nodesPerSecond = _pathStats.nodes / _pathStats.time;
 	}
-	clearPaths();
-	
-	LOG.write(LOG_LOW, "path", "best path & value = ");
-	bestPath->getValue();
-	
-	return bestPath;
+	LOG.write(LOG_MED, "path", 
+	          "depth: %d nodes: %ld time: %f (%.0f nodes/s) value: %f",
+	          _pathStats.depth, _pathStats.nodes, _pathStats.time,
+	          _pathStats.nodesPerSecond, _pathStats.value);
+	return best;
+}
+
+/********************************************
+ * Definition: Returns how far the last searchPaths got and how fast
+ *******************************************/
+PathSearchStats MapStrategy::getPathStats() {
+	return _pathStats;
 }
 
-void MapStrategy::createPaths(Path *parentPath, int length) {
-	Path *curPath = new Path(parentPath);
+/********************************************
+ * Definition: Finds the best path of the given length, giving up if
+ *             the deadline passes
+ *
+ * Parameters: the number of moves and the time to give up at, or 0
+ *             to never give up
+ *
+ * Returns:    the path, or NULL if none is worth points or the search
+ *             gave up
+ *******************************************/
+Path* MapStrategy::_getBestPath(int length, double deadline) {
+	_deadline = deadline;
+	_timeUp = false;
+	if (length > MAX_PATH_LENGTH - 1) {
+		length = MAX_PATH_LENGTH - 1;
+	}
 
-	//LOG.printfScreen(LOG_LOW, "path", "in paths... length = %d\n", length);
-	if (length == 0) {
-	//	LOG.printfScreen(LOG_LOW, "path", "pushing back path\n");
-		_pathList.push_back(curPath);
-		return ;
-	}
-
-	//LOG.printfScreen(LOG_LOW, "path", "calculating neighbors\n");
-	int openings = curPath->getLastCell()->getOpenings();
-	//LOG.printfScreen(LOG_LOW, "path", "openings: %d\n", openings);
-	//if (openings > 0) {
-		int x = curPath->getLastCell()->x;
-		int y = curPath->getLastCell()->y;
-	//LOG.printfScreen(LOG_LOW, "path", "X: %d\n", x);
-	//LOG.printfScreen(LOG_LOW, "path", "Y: %d\n", y);
-		
-
-		int newX[4] = {x, x, x-1, x+1};
-		int newY[4] = {y+1, y-1, y, y};
-
-		for (int i = 0; i < 4; i++) {
-	//		LOG.printfScreen(LOG_LOW, "path", "looping openings: %d\n", i);
-			if (_map->canOccupy(newX[i], newY[i])) {
-	//			LOG.printfScreen(LOG_LOW, "path", "branching i = %d\n", i);
-				curPath->push(_map->cells[newX[i]][newY[i]]);
-				createPaths(curPath, length-1);
-				curPath->pop();
-			}
+	Cell *start = _map->getCurrentCell();
+	int startIndex = BitBoard::indexOf(start->x, start->y);
+	_bestPath.reset(start);
+	_length = length;
+	_nodes = 0;
+	if (length < 1) {
+		return NULL;
+	}
+
+	uint64_t open = ~_board->blocked & BOARD_ALL;
+	_maxValue = 0.0;
+	for (int i = 0; i < BOARD_CELLS; i++) {
+		_values[i] = Path::cellValue(i % MAP_WIDTH, i / MAP_WIDTH, 
+		                             _board->points[i]);
+		if ((open & BitBoard::bitAt(i)) && _values[i] > _maxValue) {
+			_maxValue = _values[i];
+		}
+	}
+
+	// the first moves, in the order the search has always tried them
+	PathScore startScore = Path::startScore(start);
+	uint64_t bit = BitBoard::bitAt(startIndex);
+	uint64_t moves[4] = {bit << MAP_WIDTH, bit >> MAP_WIDTH,
+	                     (bit & ~BOARD_FIRST_COLUMN) >> 1,
+	                     (bit & ~BOARD_LAST_COLUMN) << 1};
+	int offsets[4] = {MAP_WIDTH, -MAP_WIDTH, -1, 1};
+	int heading[4] = {DIR_NORTH, DIR_SOUTH, DIR_EAST, DIR_WEST};
+
+	_numRoots = 0;
+	for (int i = 0; i < 4; i++) {
+		if (!(moves[i] & open)) {
+			continue;
+		}
+		PathRoot *root = &_roots[_numRoots++];
+		root->index = startIndex + offsets[i];
+		root->score = Path::extendScore(startScore, root->index, 
+		                                _values[root->index], heading[i]);
+		root->bestPath.reset(start);
+		root->bestValue = 0.0;
+	}
+
+	// only paths worth more than nothing count
+	FloatBits bound;
+	bound.value = 0.0;
+	_bound = bound.bits;
+	_nextRoot = 0;
+
+	int threads = 1;
+	if (length >= PATH_PARALLEL_LENGTH) {
+		threads = _threads < _numRoots ? _threads : _numRoots;
+	}
+
+	pthread_t ids[PATH_THREADS];
+	int started = 1;
+	for (int i = 1; i < threads; i++) {
+		_workers[i].nodes = 0;
+		if (pthread_create(&ids[started], NULL, _work, &_workers[i]) != 0) {
+			// this thread will pick up the roots it would have taken
+			LOG.write(LOG_HIGH, "path", "unable to start a search thread");
+			break;
+		}
+		started++;
+	}
+	_workers[0].nodes = 0;
+	_work(&_workers[0]);
+	for (int i = 1; i < started; i++) {
+		pthread_join(ids[i], NULL);
+	}
+	for (int i = 0; i < started; i++) {
+		_nodes += _workers[i].nodes;
+	}
+	if (_timeUp) {
+		return NULL;
+	}
+
+	// ties go to the earliest first move, as in a single search
+	float bestValue = 0.0;
+	int best = -1;
+	for (int i = 0; i < _numRoots; i++) {
+		if (_roots[i].bestValue > bestValue) {
+			bestValue = _roots[i].bestValue;
+			best = i;
 		}
-	//}
-	delete curPath;
+	}
+	if (best == -1) {
+		return NULL;
+	}
+
+	_bestPath = _roots[best].bestPath;
+	LOG.write(LOG_LOW, "path", "best path value = %f", bestValue);
+	return &_bestPath;
 }
 
-void MapStrategy::clearPaths() {
-	for (int i = 0; i < _pathList.size(); i++) {
-		delete _pathList[i];
+/********************************************
+ * Definition: Sets how many threads long searches are split across
+ *
+ * Parameters: the number of threads, from 1 to PATH_THREADS
+ *******************************************/
+void MapStrategy::setThreads(int threads) {
+	if (threads < 1) {
+		threads = 1;
+	}
+	else if (threads > PATH_THREADS) {
+		threads = PATH_THREADS;
 	}
-	_pathList.clear();
+	_threads = threads;
+}
+
+/********************************************
+ * Definition: Returns the number of paths the last search extended
+ *******************************************/
+long MapStrategy::getNodes() {
+	return _nodes;
+}
+
+/********************************************
+ * Definition: Searches first moves until there are none left
+ *
+ * Parameters: the PathWorker doing the searching
+ *******************************************/
+void* MapStrategy::_work(void *pathWorker) {
+	PathWorker *worker = (PathWorker*)pathWorker;
+	MapStrategy *strategy = worker->strategy;
+
+	int root = __sync_fetch_and_add(&strategy->_nextRoot, 1);
+	while (root < strategy->_numRoots) {
+		strategy->_searchRoot(worker, &strategy->_roots[root]);
+		root = __sync_fetch_and_add(&strategy->_nextRoot, 1);
+	}
+	return NULL;
+}
+
+/********************************************
+ * Definition: Searches every path that starts with the given move
+ *
+ * Parameters: the PathWorker doing the searching and the first move
+ *******************************************/
+void MapStrategy::_searchRoot(PathWorker *worker, PathRoot *root) {
+	worker->path.reset(_map->getCurrentCell());
+	worker->path.push(_map->cells[root->index % MAP_WIDTH]
+	                             [root->index / MAP_WIDTH]);
+	_search(worker, root, root->index, _length-1, root->score);
+}
+
+/********************************************
+ * Definition: Extends the path by every move it can make, until it's
+ *             long enough to be compared to the best one. Moves are
+ *             found on the bit board (see BitBoard).
+ *
+ * Parameters: the PathWorker doing the searching, the first move it's
+ *             searching below, the board index of the path's last
+ *             cell, the number of moves left and the path's score
+ *             so far
+ *******************************************/
+void MapStrategy::_search(PathWorker *worker, PathRoot *root, int index, 
+                          int length, PathScore score) {
+	worker->nodes++;
+	if (_timeUp) {
+		return;
+	}
+	if (_deadline > 0.0 && worker->nodes % PATH_CHECK_NODES == 0 &&
+	    Util::getTime() > _deadline) {
+		_timeUp = true;
+		return;
+	}
+	if (length == 0) {
+		if (score.value > root->bestValue) {
+			root->bestValue = score.value;
+			root->bestPath = worker->path;
+			_raiseBound(score.value);
+		}
+		return;
+	}
+
+	// even a cell worth the most on every move left can't catch up
+	// (not on a tie, or which path wins would depend on the threads)
+	if (score.value + length * _maxValue < _getBound()) {
+		return;
+	}
+
+	uint64_t bit = BitBoard::bitAt(index);
+	uint64_t open = ~_board->blocked & BOARD_ALL;
+
+	uint64_t moves[4] = {bit << MAP_WIDTH, bit >> MAP_WIDTH,
+	                     (bit & ~BOARD_FIRST_COLUMN) >> 1,
+	                     (bit & ~BOARD_LAST_COLUMN) << 1};
+	int offsets[4] = {MAP_WIDTH, -MAP_WIDTH, -1, 1};
+	int heading[4] = {DIR_NORTH, DIR_SOUTH, DIR_EAST, DIR_WEST};
+
+	for (int i = 0; i < 4; i++) {
+		if (!(moves[i] & open)) {
+			continue;
+		}
+
+		int next = index + offsets[i];
+		worker->path.push(_map->cells[next % MAP_WIDTH][next / MAP_WIDTH]);
+		_search(worker, root, next, length-1, 
+		        Path::extendScore(score, next, _values[next], heading[i]));
+		worker->path.pop();
+	}
+}
+
+/********************************************
+ * Definition: Returns the best value any thread has found
+ *******************************************/
+float MapStrategy::_getBound() {
+	FloatBits bound;
+	bound.bits = _bound;
+	return bound.value;
+}
+
+/********************************************
+ * Definition: Raises the best value any thread has found, if the
+ *             given one is better
+ *
+ * Parameters: the value of a path that was found
+ *******************************************/
+void MapStrategy::_raiseBound(float value) {
+	FloatBits current, next;
+	next.value = value;
+
+	do {
+		current.bits = _bound;
+		if (current.value >= value) {
+			return;
+		}
+	} while (!__sync_bool_compare_and_swap(&_bound, current.bits, next.bits));
 }
 
 /*
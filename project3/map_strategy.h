@@ -4,29 +4,103 @@
 #include "map.h"
 #include "cell.h"
 #include "path.h"
+#include "game_search.h"
+#include "planner.h"
+#include "travel_table.h"
 
-#define PATH_LENGTH 5
+#include <pthread.h>
+
+// how long to take picking each move, and how many paths the
+// search extends between looks at the clock
+#define NEXT_CELL_BUDGET 0.25 // seconds
+#define PATH_CHECK_NODES 1024
+
+// long path searches are split by first move across this many threads
+#define PATH_THREADS 4
+#define PATH_PARALLEL_LENGTH 12 // the shortest search worth splitting
 
 #define CELL_NORTH 0
 #define CELL_SOUTH 1
 #define CELL_EAST 2
 #define CELL_WEST 3
 
+class MapStrategy;
+
+// so a float can be swapped atomically (with __sync builtins) as an int
+typedef union {
+	int bits;
+	float value;
+} FloatBits;
+
+// the search below one first move of a path
+typedef struct {
+	int index;          // board index of the first move's cell
+	PathScore score;    // of the path to it
+	Path bestPath;      // the best full length path below it
+	float bestValue;
+} PathRoot;
+
+typedef struct {
+	int depth;              // the longest paths searched all the way
+	long nodes;             // paths extended, at every length
+	double time;            // seconds
+	float value;            // of the best path, at that length
+	double nodesPerSecond;
+} PathSearchStats;
+
+typedef struct {
+	MapStrategy *strategy;
+	Path path;          // this thread's path stack
+	long nodes;
+} PathWorker;
+
 class MapStrategy {
 public:
 	MapStrategy(Map *map);
 	~MapStrategy();
-	Cell* nextCell();
+	Cell* nextCell(double budget, int heading);
+	void planFrom(Cell *cell);
 	Path* getBestPath(int length);
-	void createPaths(Path *parentPath, int length);
-	void clearPaths();
+	Path* searchPaths(double budget);
+	PathSearchStats getPathStats();
+	void setThreads(int threads);
+	long getNodes();
 	
 private:
 	Map *_map;
+	GameSearch *_gameSearch;
+	Planner *_planner;
+	TravelTable *_travel;
+	int _threads;
 	
-	std::vector<Path *> _pathList;
-	
-	void createPath(Path parentPath, int num);
+	Path _bestPath;     // the best full length path found so far
+	Path _anytimePath;  // the best path of the longest length searched
+	PathSearchStats _pathStats;
+
+	double _deadline;           // 0 if the search has no time limit
+	volatile bool _timeUp;
+
+	BitBoard *_board;
+	float _values[BOARD_CELLS]; // what each cell adds to a path
+	float _maxValue;            // the most any cell adds
+
+	int _length;                // moves in the paths being searched
+	PathRoot _roots[4];
+	int _numRoots;
+	volatile int _nextRoot;     // the next root a worker should take
+	volatile int _bound;        // the best value found, as float bits
+	PathWorker _workers[PATH_THREADS];
+	long _nodes;
+
+	void _searchRoot(PathWorker *worker, PathRoot *root);
+	void _search(PathWorker *worker, PathRoot *root, int index, int length, 
+	             PathScore score);
+	float _getBound();
+	void _raiseBound(float value);
+	Path* _getBestPath(int length, double deadline);
+	Cell* _towardsBestTarget(int heading);
+
+	static void* _work(void *worker);
 };
 
 #endif
@@ -0,0 +1,170 @@
+/**
+ * motion_profile.cpp
+ * 
+ * @brief 
+ *      This class plans the speed to move or turn at over the course
+ *      of a motion with a trapezoidal profile: ramp up from the start,
+ *      cruise, then slow down so the robot comes to rest at the goal.
+ *      The planned speed is turned into a robot speed level using the
+ *      measured speed of each level (SPEED_FORWARD and SPEED_TURN in
+ *      robot.h), since levels aren't evenly spaced (or even in order 
+ *      for turns).
+ * 
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#include "motion_profile.h"
+#include "robot.h"
+#include "logger.h"
+#include <math.h>
+
+MotionProfile::MotionProfile(int type, float accel) {
+    _accel = accel;
+    _startTime = 0.0;
+    setType(type);
+}
+
+MotionProfile::~MotionProfile() {}
+
+/**************************************
+ * Definition: Sets which kind of motion is being profiled, and
+ *             with it the speeds that are available
+ *
+ * Parameters: PROFILE_FORWARD, PROFILE_TURN_LEFT or PROFILE_TURN_RIGHT
+ **************************************/
+void MotionProfile::setType(int type) {
+    _type = type;
+    _minSpeed = speedForLevel(type, 1);
+    _maxSpeed = _minSpeed;
+    for (int level = 1; level <= slowestLevel(type); level++) {
+        float speed = speedForLevel(type, level);
+        _minSpeed = speed < _minSpeed ? speed : _minSpeed;
+        _maxSpeed = speed > _maxSpeed ? speed : _maxSpeed;
+    }
+}
+
+/**************************************
+ * Definition: Starts a new motion (from rest) at the given time
+ *
+ * Parameters: double time in seconds
+ **************************************/
+void MotionProfile::start(double time) {
+    _startTime = time;
+}
+
+/**************************************
+ * Definition: Returns the planned speed: the ramp up from the
+ *             start, capped at the fastest speed, and capped again
+ *             by the speed we can still stop from in the distance 
+ *             remaining
+ *
+ * Parameters: float distance remaining (cm or radians) and 
+ *             double time in seconds
+ *
+ * Returns:    speed in cm/s (or rad/s), 0 once we should stop
+ *             and coast the rest of the way
+ **************************************/
+float MotionProfile::getSpeed(float remaining, double time) {
+    if (remaining <= getStopDistance()) {
+        return 0.0;
+    }
+    float rampUp = _minSpeed + _accel * (time - _startTime);
+    float rampDown = sqrt(2.0 * _accel * remaining);
+    float speed = _maxSpeed;
+    speed = rampUp < speed ? rampUp : speed;
+    speed = rampDown < speed ? rampDown : speed;
+    return speed;
+}
+
+/**************************************
+ * Definition: Returns the robot speed level to send for the 
+ *             planned speed
+ *
+ * Parameters: float distance remaining (cm or radians) and 
+ *             double time in seconds
+ *
+ * Returns:    speed level (1 fastest - 10 slowest), 0 to stop
+ **************************************/
+int MotionProfile::getSpeedLevel(float remaining, double time) {
+    float speed = getSpeed(remaining, time);
+    if (speed <= 0.0) {
+        return 0;
+    }
+    int level = levelForSpeed(_type, speed);
+    LOG.write(LOG_LOW, "motion_profile", 
+              "remaining: %f planned speed: %f level: %d (%f)", 
+              remaining, speed, level, speedForLevel(_type, level));
+    return level;
+}
+
+/**************************************
+ * Definition: Returns how far the robot coasts once stopped from
+ *             its slowest speed, which is as close as the profile 
+ *             can bring it before stopping
+ **************************************/
+float MotionProfile::getStopDistance() {
+    return (_minSpeed * _minSpeed) / (2.0 * _accel);
+}
+
+/**************************************
+ * Definition: Returns the slowest speed level the profile can use.
+ *             Turns stop at SLOWEST_TURN_SPEED, since the robot 
+ *             doesn't turn reliably any slower.
+ *
+ * Parameters: int profile type
+ *
+ * Returns:    speed level (1-10)
+ **************************************/
+int MotionProfile::slowestLevel(int type) {
+    if (type == PROFILE_TURN_LEFT || type == PROFILE_TURN_RIGHT) {
+        return SLOWEST_TURN_SPEED;
+    }
+    return NUM_SPEEDS - 1;
+}
+
+/**************************************
+ * Definition: Returns the measured speed of a speed level
+ *
+ * Parameters: int profile type and int speed level (1-10)
+ *
+ * Returns:    speed in cm/s (or rad/s, always positive)
+ **************************************/
+float MotionProfile::speedForLevel(int type, int level) {
+    switch (type) {
+    case PROFILE_TURN_LEFT:
+        return fabs(SPEED_TURN[level][DIR_LEFT]);
+    case PROFILE_TURN_RIGHT:
+        return fabs(SPEED_TURN[level][DIR_RIGHT]);
+    }
+    return SPEED_FORWARD[level];
+}
+
+/**************************************
+ * Definition: Returns the speed level that comes closest to a
+ *             speed without going over it (or the slowest level
+ *             if they're all too fast)
+ *
+ * Parameters: int profile type and float speed
+ *
+ * Returns:    speed level (1-10)
+ **************************************/
+int MotionProfile::levelForSpeed(int type, float speed) {
+    int best = -1;
+    int slowest = 1;
+    for (int level = 1; level <= slowestLevel(type); level++) {
+        float levelSpeed = speedForLevel(type, level);
+        if (levelSpeed < speedForLevel(type, slowest)) {
+            slowest = level;
+        }
+        // prefer the higher (gentler) level when speeds tie
+        if (levelSpeed <= speed && 
+            (best == -1 || levelSpeed >= speedForLevel(type, best))) {
+            best = level;
+        }
+    }
+    return best == -1 ? slowest : best;
+}
@@ -0,0 +1,51 @@
+/**
+ * motion_profile.h
+ * 
+ * @brief 
+ *      This class plans the speed to move or turn at over the course
+ *      of a motion with a trapezoidal profile: ramp up from the start,
+ *      cruise, then slow down so the robot comes to rest at the goal.
+ *      The planned speed is turned into a robot speed level using the
+ *      measured speed of each level (SPEED_FORWARD and SPEED_TURN in
+ *      robot.h), since levels aren't evenly spaced (or even in order 
+ *      for turns).
+ * 
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#ifndef CS1567_MOTIONPROFILE_H
+#define CS1567_MOTIONPROFILE_H
+
+#define PROFILE_FORWARD 0
+#define PROFILE_TURN_LEFT 1
+#define PROFILE_TURN_RIGHT 2
+
+// how quickly the robot speeds up and (once stopped) coasts to rest
+#define PROFILE_FORWARD_ACCEL 40.0 // cm/s^2
+#define PROFILE_TURN_ACCEL 4.0 // rad/s^2
+
+class MotionProfile {
+public:
+    MotionProfile(int type, float accel);
+    ~MotionProfile();
+    void setType(int type);
+    void start(double time);
+    float getSpeed(float remaining, double time);
+    int getSpeedLevel(float remaining, double time);
+    float getStopDistance();
+    static int slowestLevel(int type);
+    static float speedForLevel(int type, int level);
+    static int levelForSpeed(int type, float speed);
+private:
+    int _type;
+    float _accel;
+    float _minSpeed;
+    float _maxSpeed;
+    double _startTime;
+};
+
+#endif
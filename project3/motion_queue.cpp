@@ -0,0 +1,254 @@
+/**
+ * motion_queue.cpp
+ * 
+ * @brief 
+ *      This class holds the robot's upcoming motion as a queue of 
+ *      segments (a command, a speed, an optional heading to hold, and 
+ *      a duration or distance). Segments are submitted without waiting 
+ *      and get a handle that can be polled. The robot services the 
+ *      queue once per control tick, and when a segment finishes the 
+ *      next one starts on the same tick, so back to back segments 
+ *      don't stop in between.
+ * 
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#include "motion_queue.h"
+#include "constants.h"
+#include "utilities.h"
+#include "logger.h"
+#include <robot_if++.h>
+
+MotionQueue::MotionQueue() {
+    _first = 0;
+    _count = 0;
+    _nextHandle = 0;
+    _haveGoal = false;
+    _goalX = 0.0;
+    _goalY = 0.0;
+    _progress = 0.0;
+    for (int i = 0; i < MOTION_QUEUE_SIZE; i++) {
+        _segments[i].handle = MOTION_NONE;
+        _segments[i].status = MOTION_DONE;
+    }
+}
+
+MotionQueue::~MotionQueue() {}
+
+/**************************************
+ * Definition: Adds a segment to the end of the queue
+ *
+ * Parameters: pointer to the segment (it's copied)
+ *
+ * Returns:    a handle for the segment, or MOTION_NONE if
+ *             the queue is full
+ **************************************/
+MotionHandle MotionQueue::submit(MotionSegment *segment) {
+    if (isFull()) {
+        LOG.write(LOG_HIGH, "motion_queue", "queue full, dropping segment");
+        return MOTION_NONE;
+    }
+
+    QueuedSegment *queued = &_segments[(_first + _count) % MOTION_QUEUE_SIZE];
+    queued->segment = *segment;
+    queued->handle = _nextHandle++;
+    queued->status = MOTION_PENDING;
+    _count++;
+
+    LOG.write(LOG_LOW, "motion_queue", 
+              "submitted %d: command %d speed %d heading %f "
+              "duration %f distance %f", queued->handle, 
+              segment->command, segment->speed, segment->heading,
+              segment->duration, segment->distance);
+    return queued->handle;
+}
+
+/**************************************
+ * Definition: Returns the status of a submitted segment
+ *
+ * Parameters: the segment's handle
+ *
+ * Returns:    MOTION_PENDING, MOTION_ACTIVE, MOTION_DONE or
+ *             MOTION_CANCELLED. Segments old enough to have been 
+ *             dropped from the queue are done.
+ **************************************/
+int MotionQueue::getStatus(MotionHandle handle) {
+    if (handle == MOTION_NONE) {
+        return MOTION_DONE;
+    }
+    QueuedSegment *queued = &_segments[handle % MOTION_QUEUE_SIZE];
+    if (queued->handle != handle) {
+        return MOTION_DONE;
+    }
+    return queued->status;
+}
+
+/**************************************
+ * Definition: Returns true if the segment has finished 
+ *             (or been cancelled)
+ **************************************/
+bool MotionQueue::isDone(MotionHandle handle) {
+    int status = getStatus(handle);
+    return status == MOTION_DONE || status == MOTION_CANCELLED;
+}
+
+bool MotionQueue::isEmpty() {
+    return _count == 0;
+}
+
+bool MotionQueue::isFull() {
+    return _count == MOTION_QUEUE_SIZE;
+}
+
+/**************************************
+ * Definition: Returns how much of the active segment is left
+ *
+ * Returns:    cm for distance segments, seconds for timed ones,
+ *             0 if nothing is active
+ **************************************/
+float MotionQueue::getRemaining() {
+    if (_count == 0 || _segments[_first].status != MOTION_ACTIVE) {
+        return 0.0;
+    }
+    MotionSegment *segment = &_segments[_first].segment;
+    float total = segment->distance > 0 ? segment->distance : segment->duration;
+    return total - _progress;
+}
+
+/**************************************
+ * Definition: Returns how much of a submitted segment is left
+ *
+ * Parameters: the segment's handle
+ *
+ * Returns:    cm for distance segments, seconds for timed ones.
+ *             All of it if it hasn't started, 0 once it's done.
+ **************************************/
+float MotionQueue::getRemaining(MotionHandle handle) {
+    int status = getStatus(handle);
+    if (status == MOTION_ACTIVE) {
+        return getRemaining();
+    }
+    if (status == MOTION_PENDING) {
+        MotionSegment *segment = &_segments[handle % MOTION_QUEUE_SIZE].segment;
+        return segment->distance > 0 ? segment->distance : segment->duration;
+    }
+    return 0.0;
+}
+
+/**************************************
+ * Definition: Cancels every segment that hasn't finished
+ **************************************/
+void MotionQueue::cancel() {
+    for (int i = 0; i < _count; i++) {
+        _segments[(_first + i) % MOTION_QUEUE_SIZE].status = MOTION_CANCELLED;
+    }
+    _first = (_first + _count) % MOTION_QUEUE_SIZE;
+    _count = 0;
+    _haveGoal = false;
+}
+
+/**************************************
+ * Definition: Advances the queue for one control tick and picks
+ *             the command to send. Finished segments are retired
+ *             and the next segment starts right away.
+ *
+ * Parameters: the current pose, the current time (seconds), and
+ *             pointers to store the command and speed in
+ *
+ * Returns:    false once the queue is empty (the command is
+ *             then RI_STOP)
+ **************************************/
+bool MotionQueue::service(Pose *pose, double time, int *command, int *speed) {
+    while (_count > 0) {
+        QueuedSegment *queued = &_segments[_first];
+        if (queued->status == MOTION_PENDING) {
+            _start(queued, pose, time);
+        }
+        if (!_isFinished(queued, pose, time)) {
+            break;
+        }
+        queued->status = MOTION_DONE;
+        LOG.write(LOG_LOW, "motion_queue", "finished %d", queued->handle);
+        _first = (_first + 1) % MOTION_QUEUE_SIZE;
+        _count--;
+    }
+
+    if (_count == 0) {
+        _haveGoal = false;
+        *command = RI_STOP;
+        *speed = 0;
+        return false;
+    }
+
+    MotionSegment *segment = &_segments[_first].segment;
+    *command = segment->command;
+    *speed = segment->speed;
+
+    // turn back onto the heading before driving any further
+    if (segment->heading != MOTION_NO_HEADING) {
+        float thetaError = Util::normalizeThetaError(segment->heading - 
+                                                     pose->getTheta());
+        if (fabs(thetaError) > MAX_THETA_ERROR) {
+            *command = thetaError > 0 ? RI_TURN_LEFT : RI_TURN_RIGHT;
+            *speed = MOTION_TURN_SPEED;
+        }
+    }
+    return true;
+}
+
+/**************************************
+ * Definition: Starts a segment from the given pose and time. A
+ *             distance segment that follows another one starts
+ *             from where that one was headed, so small misses
+ *             don't add up over a run of segments.
+ **************************************/
+void MotionQueue::_start(QueuedSegment *queued, Pose *pose, double time) {
+    queued->status = MOTION_ACTIVE;
+    queued->startTime = time;
+    if (_haveGoal) {
+        queued->startX = _goalX;
+        queued->startY = _goalY;
+    }
+    else {
+        queued->startX = pose->getX();
+        queued->startY = pose->getY();
+    }
+    _progress = 0.0;
+
+    MotionSegment *segment = &queued->segment;
+    _haveGoal = segment->distance > 0 && segment->heading != MOTION_NO_HEADING;
+    if (_haveGoal) {
+        _goalX = queued->startX + segment->distance * cos(segment->heading);
+        _goalY = queued->startY + segment->distance * sin(segment->heading);
+    }
+
+    LOG.write(LOG_LOW, "motion_queue", "started %d from (%f, %f)", 
+              queued->handle, queued->startX, queued->startY);
+}
+
+/**************************************
+ * Definition: Updates a segment's progress and returns true once
+ *             it has gone its distance or run for its duration
+ **************************************/
+bool MotionQueue::_isFinished(QueuedSegment *queued, Pose *pose, double time) {
+    MotionSegment *segment = &queued->segment;
+    if (segment->distance > 0) {
+        float deltaX = pose->getX() - queued->startX;
+        float deltaY = pose->getY() - queued->startY;
+        if (segment->heading != MOTION_NO_HEADING) {
+            _progress = deltaX * cos(segment->heading) + 
+                        deltaY * sin(segment->heading);
+        }
+        else {
+            _progress = sqrt(deltaX*deltaX + deltaY*deltaY);
+        }
+        return _progress >= segment->distance;
+    }
+
+    _progress = time - queued->startTime;
+    return _progress >= segment->duration;
+}
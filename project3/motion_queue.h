@@ -0,0 +1,88 @@
+/**
+ * motion_queue.h
+ * 
+ * @brief 
+ *      This class holds the robot's upcoming motion as a queue of 
+ *      segments (a command, a speed, an optional heading to hold, and 
+ *      a duration or distance). Segments are submitted without waiting 
+ *      and get a handle that can be polled. The robot services the 
+ *      queue once per control tick, and when a segment finishes the 
+ *      next one starts on the same tick, so back to back segments 
+ *      don't stop in between.
+ * 
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#ifndef CS1567_MOTIONQUEUE_H
+#define CS1567_MOTIONQUEUE_H
+
+#include "pose.h"
+
+#define MOTION_QUEUE_SIZE 8
+
+// speed used to turn back onto a segment's heading
+#define MOTION_TURN_SPEED 6
+
+#define MOTION_NONE -1
+#define MOTION_NO_HEADING -1.0
+
+// segment status
+#define MOTION_PENDING 0
+#define MOTION_ACTIVE 1
+#define MOTION_DONE 2
+#define MOTION_CANCELLED 3
+
+typedef int MotionHandle;
+
+typedef struct {
+    int command;      // robot interface command (RI_MOVE_FORWARD, ...)
+    int speed;
+    float heading;    // global theta to hold, or MOTION_NO_HEADING
+    float duration;   // seconds, or 0 to go by distance
+    float distance;   // cm (along the heading if there is one), 
+                      // or 0 to go by duration
+} MotionSegment;
+
+class MotionQueue {
+public:
+    MotionQueue();
+    ~MotionQueue();
+    MotionHandle submit(MotionSegment *segment);
+    int getStatus(MotionHandle handle);
+    bool isDone(MotionHandle handle);
+    bool isEmpty();
+    bool isFull();
+    float getRemaining();
+    float getRemaining(MotionHandle handle);
+    void cancel();
+    bool service(Pose *pose, double time, int *command, int *speed);
+private:
+    typedef struct {
+        MotionSegment segment;
+        MotionHandle handle;
+        int status;
+        float startX, startY;
+        double startTime;
+    } QueuedSegment;
+
+    QueuedSegment _segments[MOTION_QUEUE_SIZE];
+    int _first;
+    int _count;
+    MotionHandle _nextHandle;
+
+    // where the last distance segment was headed, so the next one
+    // is measured from there instead of from wherever we ended up
+    bool _haveGoal;
+    float _goalX, _goalY;
+
+    float _progress;
+
+    void _start(QueuedSegment *queued, Pose *pose, double time);
+    bool _isFinished(QueuedSegment *queued, Pose *pose, double time);
+};
+
+#endif
@@ -25,18 +25,26 @@ NorthStar::NorthStar(Robot *robot)
 : PositionSensor(robot), _oldX(), _oldY() {
 	_lastRoom = -1;
 
+	_calibration = new Calibration(Calibration::fileNameFor(robot->getName()));
+	_blender = new RoomBlender(_calibration);
+	_blending = NS_BLEND_ROOMS;
+	_lastTheta = 0.0;
+
 	_filterX = new FIRFilter("filters/ns_x.ffc");
 	_filterY = new FIRFilter("filters/ns_y.ffc");
 	_filterTheta = new FIRFilter("filters/ns_theta.ffc");
+	_lastSequence = 0;
 	
-	_oldX.resize(_filterX->getOrder(), 0);
-	_oldY.resize(_filterY->getOrder(), 0);
+	_oldX.resize(_filterX->getOrder()+1, 0);
+	_oldY.resize(_filterY->getOrder()+1, 0);
 }
 
 NorthStar::~NorthStar() {
 	delete _filterX;
 	delete _filterY;
 	delete _filterTheta;
+	delete _blender;
+	delete _calibration;
 }
 
 /**************************************************
@@ -46,36 +54,35 @@ NorthStar::~NorthStar() {
  * 		       Specific corrections for room changes and non-linearity are 
  *             included here as well
  *
- * Note:       Requires the interface be updated prior to calling 
+ * Note:       Reads the robot's latest sensor snapshot, and does 
+ *             nothing if that's the same one it saw last time
  *************************************************/
 void NorthStar::updatePose() {
+	SensorSnapshot *snapshot = _robot->getSnapshot();
+	if (snapshot->sequence == _lastSequence) {
+		return;
+	}
+	_lastSequence = snapshot->sequence;
+
 	int room = _robot->getRoom();
-	int name = _robot->getName();
+
+	// pick up a new calibration file if we've been asked to
+	_calibration->reloadIfRequested();
+	if (!_calibration->hasRoom(room)) {
+		LOG.write(LOG_HIGH, "NS_room_change", 
+				  "No calibration for room %d, keeping last pose.", room+2);
+		return;
+	}
+
+	if (_blending) {
+		_updateBlended(room);
+		return;
+	}
 
 	// if we've changed rooms, prepare filters for this
 	if (_lastRoom != -1 && _lastRoom != room) {
-
 		LOG.write(LOG_MED, "NS_room_change", "Room change occurring.\n");
-
-		// assume X and Y fir filters are of the same order
-		int order = _filterX->getOrder(); 
-		Pose *tempPose = new Pose(0.0, 0.0, 0.0);
-		// adjust old filtered values according to new room
-		for (int i = 0; i <= order; i++) {
-			tempPose->reset(_oldX[i], _oldY[i], 0.0);
-			
-			tempPose->translate(-COL_OFFSET[0] - NS_ROOM_ORIGINS_FROM_COL[name][room][0], 
-							    -COL_OFFSET[1] - NS_ROOM_ORIGINS_FROM_COL[name][room][1]);
-			tempPose->scale(1.0/NS_ROOM_SCALE[name][room][0], 1.0/NS_ROOM_SCALE[name][room][1]);
-			tempPose->rotate(-NS_ROOM_ROTATION[name][room]);
-		
-			_oldX[i] = tempPose->getX();
-			_oldY[i] = tempPose->getY();
-		}
-		// use these updated values to seed the filters in preparation
-		_filterX->seed(&_oldX);
-		_filterY->seed(&_oldY);
-		_filterTheta->seed(_robot->getInterface()->Theta());
+		_reseedFilters(room);
 	}
 
 	_lastRoom = room;
@@ -90,52 +97,133 @@ void NorthStar::updatePose() {
 			  room+2, x, y, theta);
 
 	// transform the data into global coord system
-	Pose *estimate = new Pose(x, y, theta);
-	if (room == ROOM_2) {
-		// Apply specific linear transformation to Room 2, 
-		// to correct for theta skew
-		float xFitAngle = 0.0000204488 * x - 0.0804;
-		float yFitAngle = 0.0000204488 * y - 0.0804;
-		estimate->rotateEach(xFitAngle, yFitAngle, NS_ROOM_ROTATION[name][room]);
-	}
-	else {
-		estimate->rotate(NS_ROOM_ROTATION[name][room]);
-	}
-
-	estimate->rotateEach(0, 0, THETA_SHIFT[name][room]);
+	// and update our pose with new global coords
+	_pose.reset(x, y, theta);
+	_calibration->toGlobal(room, &_pose);
 
-	float sx = NS_ROOM_SCALE[name][room][0];
-	float sy = NS_ROOM_SCALE[name][room][1];
-	estimate->scale(sx, sy);
+	LOG.write(LOG_LOW, "northStarUpdate", 
+			  "north star (pose) room %d: (%f, %f, %f)",
+		      room+2, _pose.getX(), _pose.getY(), _pose.getTheta());
 
-	float tx = COL_OFFSET[0] + NS_ROOM_ORIGINS_FROM_COL[name][room][0];
-	float ty = COL_OFFSET[1] + NS_ROOM_ORIGINS_FROM_COL[name][room][1];
-	estimate->translate(tx, ty);
+	// store the global x and y for future use
+	_oldX.insert(_oldX.begin(), _pose.getX());
+	_oldX.pop_back();
+	_oldY.insert(_oldY.begin(), _pose.getY());
+	_oldY.pop_back();
+}
 
-	// update our pose with new global coords
-	_pose->setX(estimate->getX());
-	_pose->setY(estimate->getY());
-	_pose->setTheta(estimate->getTheta());
-	delete estimate;
+/**************************************************
+ * Definition: Updates the pose by blending the estimates of every
+ *             recently seen room (see RoomBlender). The filters run
+ *             on global coordinates in this mode, so a room change
+ *             doesn't need them reseeded.
+ *
+ * Parameters: int specifying the room the robot sees
+ *************************************************/
+void NorthStar::_updateBlended(int room) {
+	SensorSnapshot *snapshot = _robot->getSnapshot();
+
+	Pose blended(0.0, 0.0, 0.0);
+	_blender->update(room, snapshot->x, snapshot->y, snapshot->theta,
+					 snapshot->strength, &blended);
+
+	float x = _filterX->filter(blended.getX());
+	float y = _filterY->filter(blended.getY());
+	// unwrap theta around the last value so the filter never
+	// averages across the 0/2PI boundary
+	float theta = _lastTheta + 
+				  Util::normalizeThetaError(blended.getTheta() - _lastTheta);
+	theta = _filterTheta->filter(theta);
+	_lastTheta = Util::normalizeTheta(theta);
+
+	_pose.reset(x, y, theta);
+	_lastRoom = room;
 
 	LOG.write(LOG_LOW, "northStarUpdate", 
-			  "north star (pose) room %d: (%f, %f, %f)",
-		      room+2, _pose->getX(), _pose->getY(), _pose->getTheta());
+			  "north star (blended pose) room %d: (%f, %f, %f)",
+		      room+2, _pose.getX(), _pose.getY(), _pose.getTheta());
 
-	// store the global x and y for future use
-	_oldX.insert(_oldX.begin(), _pose->getX());
+	_oldX.insert(_oldX.begin(), _pose.getX());
 	_oldX.pop_back();
-	_oldY.insert(_oldY.begin(), _pose->getY());
+	_oldY.insert(_oldY.begin(), _pose.getY());
 	_oldY.pop_back();
 }
 
+/**************************************************
+ * Definition: Converts the stored global x and y history into the
+ *             given room's coordinates and seeds the filters with it,
+ *             so filtered values don't jump when the room changes
+ *
+ * Parameters: int specifying the room the filters will now be fed from
+ *************************************************/
+void NorthStar::_reseedFilters(int room) {
+	// assume X and Y fir filters are of the same order
+	int order = _filterX->getOrder(); 
+	Pose tempPose(0.0, 0.0, 0.0);
+	// adjust old filtered values according to new room
+	for (int i = 0; i <= order; i++) {
+		tempPose.reset(_oldX[i], _oldY[i], 0.0);
+		_calibration->toRoom(room, &tempPose);
+	
+		_oldX[i] = tempPose.getX();
+		_oldY[i] = tempPose.getY();
+	}
+	// use these updated values to seed the filters in preparation
+	_filterX->seed(&_oldX);
+	_filterY->seed(&_oldY);
+	_filterTheta->seed(_robot->getSnapshot()->theta);
+}
+
+/**************************************
+ * Definition: Turns blending of room estimates at room
+ *             boundaries on or off
+ *
+ * Parameters: bool specifying if blending should be used
+ **************************************/
+void NorthStar::setBlending(bool blending) {
+	if (blending == _blending) {
+		return;
+	}
+	_blending = blending;
+
+	if (_blending) {
+		// the filters will be fed global values from now on
+		_blender->reset();
+		_filterX->seed(&_oldX);
+		_filterY->seed(&_oldY);
+		_lastTheta = _pose.getTheta();
+		_filterTheta->seed(_lastTheta);
+	}
+	else if (_lastRoom != -1) {
+		// back to room coordinates
+		_reseedFilters(_lastRoom);
+	}
+}
+
+/**************************************
+ * Definition: Returns whether room estimates are being blended
+ **************************************/
+bool NorthStar::isBlending() {
+	return _blending;
+}
+
+/**************************************
+ * Definition: Returns the calibration used to transform
+ *             north star data into the global coord system
+ *
+ * Returns:    a pointer to the calibration
+ **************************************/
+Calibration* NorthStar::getCalibration() {
+	return _calibration;
+}
+
 /**************************************
  * Definition: Returns filtered x from north star sensor
  *
  * Returns: filtered float coordinate
  **************************************/
 float NorthStar::_getFilteredX() {
-    int x = _robot->getInterface()->X();
+    int x = _robot->getSnapshot()->x;
     return _filterX->filter((float) x);
 }
 
@@ -145,7 +233,7 @@ float NorthStar::_getFilteredX() {
  * Returns: filtered float coordinate
  **************************************/
 float NorthStar::_getFilteredY() {
-    int y = _robot->getInterface()->Y();
+    int y = _robot->getSnapshot()->y;
     return _filterY->filter((float) y);
 }
 
@@ -155,6 +243,6 @@ float NorthStar::_getFilteredY() {
  * Returns: filtered float theta
  **************************************/
 float NorthStar::_getFilteredTheta() {
-    float theta = _robot->getInterface()->Theta();
+    float theta = _robot->getSnapshot()->theta;
     return _filterTheta->filter(theta);
 }
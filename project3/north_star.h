@@ -20,20 +20,32 @@
 
 #include "position_sensor.h"
 #include "fir_filter.h"
+#include "calibration.h"
+#include "room_blender.h"
 
 class NorthStar : public PositionSensor {
 public:
 	NorthStar(Robot *robot);
 	~NorthStar();
 	void updatePose();
+	Calibration* getCalibration();
+	void setBlending(bool blending);
+	bool isBlending();
 private:
+	Calibration *_calibration;
+	RoomBlender *_blender;
+	bool _blending;
+	float _lastTheta;
 	FIRFilter *_filterX;
 	FIRFilter *_filterY;
 	FIRFilter *_filterTheta;
 	int _lastRoom;
+	unsigned int _lastSequence;
 	std::vector<float> _oldX;
 	std::vector<float> _oldY;
 
+	void _updateBlended(int room);
+	void _reseedFilters(int room);
 	float _getFilteredX();
 	float _getFilteredY();
 	float _getFilteredTheta();
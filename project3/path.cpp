@@ -47,16 +47,16 @@ float NS_PENALTY[MAP_WIDTH][MAP_HEIGHT] = {
 };
 
 Path::Path() 
-: _cells() {	
+: _length(0) {	
 }
 
 Path::Path(Cell *cell) 
-: _cells() {
+: _length(0) {
 	push(cell);
 }
 
 Path::Path(Path *path) 
-: _cells() {
+: _length(0) {
 	for (int i = 0; i < path->length(); i++) {
 		push(path->getCell(i));
 	}
@@ -65,43 +65,60 @@ Path::Path(Path *path)
 Path::~Path() {}
 
 void Path::push(Cell *cell) {
-	_cells.push_back(cell);
+	if (_length < MAX_PATH_LENGTH) {
+		_cells[_length++] = cell;
+	}
 }
 
 void Path::pop() {
-	_cells.pop_back();
+	if (_length > 0) {
+		_length--;
+	}
+}
+
+/**************************************
+ * Definition: Empties the path and starts it again at the given cell
+ *
+ * Parameters: the cell the path starts at
+ **************************************/
+void Path::reset(Cell *cell) {
+	_length = 0;
+	push(cell);
 }
 
 int Path::length() {
-	return _cells.size();
+	return _length;
 }
 
 int Path::getHeading(int upTo) {
-	int heading = -1;
-
 	if (upTo > 1) {
-		Cell *curCell = getCell(upTo-1);
-		Cell *prevCell = getCell(upTo-2);
-
-		if (curCell->x != prevCell->x) {
-			if (curCell->x > prevCell->x) {
-				heading = DIR_WEST;
-			}
-			else {
-				heading = DIR_EAST;
-			}
+		return headingBetween(getCell(upTo-2), getCell(upTo-1));
+	}
+	return -1;
+}
+
+/**************************************
+ * Definition: The direction of the move between two neighbouring cells
+ *
+ * Parameters: the cell moved from and the cell moved to
+ *
+ * Returns:    DIR_NORTH, DIR_SOUTH, DIR_EAST or DIR_WEST, or -1 if
+ *             they're the same cell
+ **************************************/
+int Path::headingBetween(Cell *from, Cell *to) {
+	if (to->x != from->x) {
+		if (to->x > from->x) {
+			return DIR_WEST;
 		}
-		else if (curCell->y != prevCell->y) {
-			if (curCell->y > prevCell->y) {
-				heading = DIR_NORTH;
-			}
-			else {
-				heading = DIR_SOUTH;
-			}
+		return DIR_EAST;
+	}
+	else if (to->y != from->y) {
+		if (to->y > from->y) {
+			return DIR_NORTH;
 		}
+		return DIR_SOUTH;
 	}
-
-	return heading;
+	return -1;
 }
 
 /** 
@@ -111,84 +128,124 @@ int Path::getHeading(int upTo) {
  * percentage. Then, the amount of times the robot
  * must change directions is summed and subtracted
  * from the final path value.
+ *
+ * The path is scored one cell at a time the same way
+ * the search does it (see startScore and extendScore).
 **/
 float Path::getValue() {
-	float value = 0.0;
-
-	bool used[MAP_WIDTH][MAP_HEIGHT] = {
-		{false, false, false, false, false},
-		{false, false, false, false, false},
-		{false, false, false, false, false},
-		{false, false, false, false, false},
-		{false, false, false, false, false},
-		{false, false, false, false, false},
-		{false, false, false, false, false}
-	};
-
-	int opponentX=-1, opponentY=-1;
+	if (length() == 0) {
+		return 0.0;
+	}
 
+#if PATH_LOG
 	LOG.write(LOG_LOW, "path", "\n\nPATH:\n");
-	int directionChanges = 0;
-	for (int i = 0; i < length(); i++) {
+	LOG.write(LOG_LOW, "path", "%d, %d", getCell(0)->x, getCell(0)->y);
+#endif
+
+	PathScore score = startScore(getCell(0));
+	for (int i = 1; i < length(); i++) {
 		Cell *nextCell = getCell(i);
+		score = extendScore(score, nextCell, 
+		                    headingBetween(getCell(i-1), nextCell));
 
-		int nextX = nextCell->x;
-		int nextY = nextCell->y;
+#if PATH_LOG
+		LOG.write(LOG_LOW, "path", "%d, %d", nextCell->x, nextCell->y);
+#endif
+		//apply penalty based on the location of the other robot
+		// to the cell iff they are fairly close
+		/*
+		int diff = abs(curX-)+abs(curY-opponentY);
+		if(diff != 0 && diff <= 3)
+			value -= (1-(1/(2*diff)))*nextCell->getPoints();
+		*/
+	}
 
-		LOG.write(LOG_LOW, "path", "%d, %d", nextX,nextY);
+#if PATH_LOG
+	LOG.printfScreen(LOG_LOW, "path", "Path Value = %f\n", score.value);
+#endif
+	return score.value;
+}
 
-		if (!used[nextX][nextY]) {
-			int points = nextCell->getPoints();
-			value += (float)points * (1-NS_PENALTY[nextX][nextY]);
-			used[nextX][nextY] = true;
-		}
+/**************************************
+ * Definition: Starts scoring a path at the given cell
+ *
+ * Parameters: the cell the path starts at
+ *
+ * Returns:    the score of a path holding only that cell
+ **************************************/
+PathScore Path::startScore(Cell *cell) {
+	PathScore score;
+	score.value = cellValue(cell);
+	score.visited = cellBit(cell);
+	score.heading = -1;
+	return score;
+}
 
-		if (i > 1) {
-			Cell *curCell = getCell(i-1);
-			int curX = curCell->x;
-			int curY = curCell->y;
-
-			int heading = getHeading(i);
-			switch (heading) {
-			case DIR_NORTH:
-				if (nextY < curY || nextX != curX) {
-					directionChanges++;
-				}
-				break;
-			case DIR_SOUTH:
-				if (nextY > curY || nextX != curX) {
-					directionChanges++;
-				}
-				break;
-			case DIR_EAST:
-				if (nextX > curX || nextY != curY) {
-					directionChanges++;
-				}
-				break;
-			case DIR_WEST:
-				if (nextX < curX || nextY != curY) {
-					directionChanges++;
-				}
-				break;
-			}
-			//apply penalty based on the location of the other robot
-			// to the cell iff they are fairly close
-			/*
-			int diff = abs(curX-)+abs(curY-opponentY);
-			if(diff != 0 && diff <= 3)
-				value -= (1-(1/(2*diff)))*nextCell->getPoints();
-			*/
-		}
+/**************************************
+ * Definition: Scores a path one cell longer than the given one.
+ *             The cell's value only counts the first time the path
+ *             goes through it, and every change of direction costs
+ *             a point.
+ *
+ * Parameters: the score so far, the next cell and the heading of
+ *             the move into it
+ *
+ * Returns:    the score of the longer path
+ **************************************/
+PathScore Path::extendScore(PathScore score, Cell *cell, int heading) {
+	return extendScore(score, BitBoard::indexOf(cell->x, cell->y),
+	                   cellValue(cell), heading);
+}
+
+/**************************************
+ * Definition: Same as above, for a cell given by its bit board index
+ *             and value (see cellValue)
+ **************************************/
+PathScore Path::extendScore(PathScore score, int index, float value,
+                            int heading) {
+	uint64_t bit = BitBoard::bitAt(index);
+	if (!(score.visited & bit)) {
+		score.value += value;
+		score.visited |= bit;
+	}
+	if (score.heading != -1 && heading != score.heading) {
+		score.value -= 1.0;
 	}
+	score.heading = heading;
+	return score;
+}
 
-	value -= (float)directionChanges;
+/**************************************
+ * Definition: The bit standing for a cell in PathScore::visited
+ *
+ * Parameters: the cell
+ **************************************/
+uint64_t Path::cellBit(Cell *cell) {
+	return BitBoard::bitAt(BitBoard::indexOf(cell->x, cell->y));
+}
+
+/**************************************
+ * Definition: The points a cell is worth to a path, knocked down by
+ *             how badly the north star sees it
+ *
+ * Parameters: the cell
+ *
+ * Returns:    the cell's value
+ **************************************/
+float Path::cellValue(Cell *cell) {
+	return cellValue(cell->x, cell->y, cell->getPoints());
+}
 
-	LOG.printfScreen(LOG_LOW, "path", "Path Value = %f\n", value);
-	return value;
+/**************************************
+ * Definition: Same as above, for the cell at x and y worth the
+ *             given points
+ **************************************/
+float Path::cellValue(int x, int y, int points) {
+	return (float)points * (1-NS_PENALTY[x][y]);
 }
 
 Cell* Path::getCell(int i) {
-	if (length() > i) {
+	if (i >= 0 && length() > i) {
 		return _cells[i];
 	}
 	return NULL;
@@ -3,7 +3,23 @@
 
 #include "cell.h"
 #include "logger.h"
-#include <vector>
+
+#include <stdint.h>
+
+// build with -DPATH_LOG=1 to log every path as it's scored
+#ifndef PATH_LOG
+#define PATH_LOG 0
+#endif
+
+// the most cells a path can hold (the starting cell included)
+#define MAX_PATH_LENGTH 16
+
+// the running score of a path, carried along as it's extended
+typedef struct {
+	float value;
+	uint64_t visited;   // a bit per cell the path has been through
+	int heading;        // of the last move, -1 before the first
+} PathScore;
 
 class Path {
 public:
@@ -13,14 +29,25 @@ public:
 	~Path();
 	void push(Cell *cell);
 	void pop();
+	void reset(Cell *cell);
 	int length();
 	int getHeading(int upTo);
 	float getValue();
 	Cell* getCell(int i);
 	Cell* getFirstCell();
 	Cell* getLastCell();
+
+	static float cellValue(Cell *cell);
+	static float cellValue(int x, int y, int points);
+	static int headingBetween(Cell *from, Cell *to);
+	static PathScore startScore(Cell *cell);
+	static PathScore extendScore(PathScore score, Cell *cell, int heading);
+	static PathScore extendScore(PathScore score, int index, float value,
+	                             int heading);
+	static uint64_t cellBit(Cell *cell);
 private:
-	std::vector<Cell*> _cells;
+	Cell *_cells[MAX_PATH_LENGTH];
+	int _length;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,156 @@
+/**
+ * pid_gains.cpp
+ *
+ * @brief
+ *      This class holds the gains for each of the robot's PID loops.
+ *      They start out as the hand-tuned values in constants.h and can
+ *      be overridden per robot by a gains file, which is what the
+ *      tuner in data/tune_pid.cpp writes.
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#include "pid_gains.h"
+#include "utilities.h"
+#include "logger.h"
+
+#include <stdio.h>
+#include <string.h>
+
+PIDGains::PIDGains() {
+    PIDConstants move = {PID_MOVE_KP, PID_MOVE_KI, PID_MOVE_KD};
+    PIDConstants turn = {PID_TURN_KP, PID_TURN_KI, PID_TURN_KD};
+    PIDConstants centerTurn = {PID_CENTERTURN_KP, PID_CENTERTURN_KI, PID_CENTERTURN_KD};
+    PIDConstants centerStrafe = {PID_CENTERSTRAFE_KP, PID_CENTERSTRAFE_KI, PID_CENTERSTRAFE_KD};
+
+    _gains[PID_LOOP_MOVE] = move;
+    _gains[PID_LOOP_TURN] = turn;
+    _gains[PID_LOOP_CENTERTURN] = centerTurn;
+    _gains[PID_LOOP_CENTERSTRAFE] = centerStrafe;
+}
+
+PIDGains::~PIDGains() {}
+
+/**************************************
+ * Definition: Reads a gains file. Each non-comment line holds
+ *             one loop:
+ *
+ *             loop kp ki kd
+ *
+ *             where loop is one of PID_LOOP_NAMES. Loops that
+ *             aren't in the file keep their current gains.
+ *
+ * Parameters: the file to read
+ *
+ * Returns:    true if at least one loop was read
+ **************************************/
+bool PIDGains::load(std::string fileName) {
+    FILE *file = fopen(fileName.c_str(), "r");
+    if (file == NULL) {
+        LOG.write(LOG_MED, "pid_gains",
+                  "No gains file %s, using default gains", fileName.c_str());
+        return false;
+    }
+
+    bool found = false;
+    char line[256];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        char *start = line;
+        while (*start == ' ' || *start == '\t') {
+            start++;
+        }
+        if (*start == '#' || *start == '\0' || 
+            *start == '\n' || *start == '\r') {
+            continue;
+        }
+
+        char name[32];
+        PIDConstants constants;
+        int numRead = sscanf(start, "%31s %f %f %f", name, &constants.kp,
+                             &constants.ki, &constants.kd);
+        int loop = loopFrom(name);
+        if (numRead != 4 || loop < 0) {
+            LOG.write(LOG_HIGH, "pid_gains",
+                      "Skipping bad gains line: %s", start);
+            continue;
+        }
+
+        _gains[loop] = constants;
+        found = true;
+    }
+    fclose(file);
+
+    LOG.write(LOG_MED, "pid_gains", "Loaded gains file %s", fileName.c_str());
+    return found;
+}
+
+/**************************************
+ * Definition: Returns the gains for a loop
+ *
+ * Parameters: int specifying the loop (ie, PID_LOOP_TURN)
+ **************************************/
+PIDConstants* PIDGains::get(int loop) {
+    return &_gains[loop];
+}
+
+/**************************************
+ * Definition: Sets the gains for a loop
+ *
+ * Parameters: int specifying the loop and the new gains
+ **************************************/
+void PIDGains::set(int loop, PIDConstants *constants) {
+    _gains[loop] = *constants;
+}
+
+/**************************************
+ * Definition: Writes every loop's gains in the format read by load()
+ *
+ * Parameters: the file to write and the robot's name
+ *
+ * Returns:    true on success
+ **************************************/
+bool PIDGains::write(std::string fileName, std::string robotName) {
+    FILE *file = fopen(fileName.c_str(), "w");
+    if (file == NULL) {
+        return false;
+    }
+
+    fprintf(file, "# pid gains for %s\n", robotName.c_str());
+    fprintf(file, "# loop\tkp\tki\tkd\n");
+    for (int i = 0; i < NUM_PID_LOOPS; i++) {
+        fprintf(file, "%s\t%.4f\t%.4f\t%.4f\n", PID_LOOP_NAMES[i],
+                _gains[i].kp, _gains[i].ki, _gains[i].kd);
+    }
+
+    fclose(file);
+    return true;
+}
+
+/**************************************
+ * Definition: Returns the default gains file path for a robot
+ *
+ * Parameters: int specifying the robot's name
+ **************************************/
+std::string PIDGains::fileNameFor(int name) {
+    return std::string(CALIBRATION_DIR) + ROBOTS[name] + PID_GAINS_EXT;
+}
+
+/**************************************
+ * Definition: Looks up a loop by its name in a gains file
+ *
+ * Parameters: the loop's name (ie, "centerturn")
+ *
+ * Returns:    the loop, or -1 if there isn't one by that name
+ **************************************/
+int PIDGains::loopFrom(const char *name) {
+    for (int i = 0; i < NUM_PID_LOOPS; i++) {
+        if (strcmp(name, PID_LOOP_NAMES[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
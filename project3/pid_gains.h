@@ -0,0 +1,56 @@
+/**
+ * pid_gains.h
+ *
+ * @brief
+ *      This class holds the gains for each of the robot's PID loops.
+ *      They start out as the hand-tuned values in constants.h and can
+ *      be overridden per robot by a gains file, which is what the
+ *      tuner in data/tune_pid.cpp writes.
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#ifndef CS1567_PIDGAINS_H
+#define CS1567_PIDGAINS_H
+
+#include "PID.h"
+#include "calibration.h"
+
+#include <string>
+
+#define PID_GAINS_EXT ".pid"
+
+#define PID_LOOP_MOVE 0
+#define PID_LOOP_TURN 1
+#define PID_LOOP_CENTERTURN 2
+#define PID_LOOP_CENTERSTRAFE 3
+#define NUM_PID_LOOPS 4
+
+// the name of each loop in a gains file
+const char * const PID_LOOP_NAMES[NUM_PID_LOOPS] = {
+    "move",
+    "turn",
+    "centerturn",
+    "centerstrafe"
+};
+
+class PIDGains {
+public:
+    PIDGains();
+    ~PIDGains();
+    bool load(std::string fileName);
+    PIDConstants* get(int loop);
+    void set(int loop, PIDConstants *constants);
+    bool write(std::string fileName, std::string robotName);
+
+    static std::string fileNameFor(int name);
+    static int loopFrom(const char *name);
+private:
+    PIDConstants _gains[NUM_PID_LOOPS];
+};
+
+#endif
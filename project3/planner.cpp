@@ -0,0 +1,266 @@
+/**
+ * planner.cpp
+ *
+ * @brief
+ *      This class plans our next move on its own thread while the
+ *      robot is still driving into the cell before it. It searches a
+ *      predicted copy of the board, with us already in that cell (see
+ *      GameSearch::search), and the plan is only used if the map still
+ *      matches the prediction once we get there: if the opponent moved
+ *      or any pellet changed, it's thrown away and planned again.
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#include "planner.h"
+#include "logger.h"
+
+#include <string.h>
+
+Planner::Planner(Map *map) {
+	_map = map;
+	_search = new GameSearch(map);
+	_running = false;
+	_state = PLANNER_IDLE;
+	_requested = false;
+	_hurry = false;
+	_us = -1;
+	_them = -1;
+	_plan = -1;
+	memset(&_planStats, 0, sizeof(GameSearchStats));
+	_changed = 0;
+	_opponentMoved = false;
+	memset(&_stats, 0, sizeof(PlannerStats));
+	pthread_mutex_init(&_mutex, NULL);
+	pthread_cond_init(&_cond, NULL);
+	_map->subscribe(this);
+}
+
+Planner::~Planner() {
+	stop();
+	_map->unsubscribe(this);
+	pthread_cond_destroy(&_cond);
+	pthread_mutex_destroy(&_mutex);
+	delete _search;
+}
+
+/**************************************
+ * Definition: Starts the planner thread
+ *
+ * Returns:    false if the thread couldn't be created
+ **************************************/
+bool Planner::start() {
+	if (_running) {
+		return true;
+	}
+	_running = true;
+	if (pthread_create(&_thread, NULL, _run, this) != 0) {
+		LOG.write(LOG_HIGH, "planner", "unable to start planner thread");
+		_running = false;
+		return false;
+	}
+	return true;
+}
+
+/**************************************
+ * Definition: Stops the planner thread, cutting short any plan, and
+ *             waits for it to finish
+ **************************************/
+void Planner::stop() {
+	if (!_running) {
+		return;
+	}
+	pthread_mutex_lock(&_mutex);
+	_running = false;
+	_search->setAbort(true);
+	pthread_cond_broadcast(&_cond);
+	pthread_mutex_unlock(&_mutex);
+	pthread_join(_thread, NULL);
+}
+
+/**************************************
+ * Definition: Starts planning the move after the given cell, as if
+ *             we were already in it. Any plan still being made is
+ *             cut short and dropped.
+ *
+ * Parameters: the cell we're driving into
+ **************************************/
+void Planner::planFrom(Cell *cell) {
+	if (!_running) {
+		return;
+	}
+
+	pthread_mutex_lock(&_mutex);
+	while (_state == PLANNER_PLANNING) {
+		_search->setAbort(true);
+		pthread_cond_wait(&_cond, &_mutex);
+	}
+
+	// the board once we've eaten the cell's pellet
+	_predicted = *_map->getBoard();
+	_us = BitBoard::indexOf(cell->x, cell->y);
+	uint64_t bit = BitBoard::bitAt(_us);
+	_predicted.blocked |= bit;
+	_predicted.occupied |= bit;
+	_predicted.pellet &= ~bit;
+	_predicted.points[_us] = 0;
+
+	Cell *theirCell = _map->getOpponentCell();
+	_them = -1;
+	if (theirCell != NULL && theirCell != cell) {
+		_them = BitBoard::indexOf(theirCell->x, theirCell->y);
+	}
+
+	_plan = -1;
+	memset(&_planStats, 0, sizeof(GameSearchStats));
+	_changed = 0;
+	_opponentMoved = false;
+	_state = PLANNER_IDLE;
+	_requested = true;
+	_hurry = false;
+	_stats.requests++;
+	pthread_cond_broadcast(&_cond);
+	pthread_mutex_unlock(&_mutex);
+}
+
+/**************************************
+ * Definition: Returns whether there's a plan being made or waiting
+ *             to be picked up
+ **************************************/
+bool Planner::isPlanning() {
+	pthread_mutex_lock(&_mutex);
+	bool planning = _requested || _state != PLANNER_IDLE;
+	pthread_mutex_unlock(&_mutex);
+	return planning;
+}
+
+/**************************************
+ * Definition: Picks up the plan, cutting it short with the best move
+ *             found so far if it's still being made. The map should
+ *             have just been updated.
+ *
+ * Returns:    the cell to move to, or NULL if there's no plan, the
+ *             map no longer matches the one it was planned on, or it
+ *             was picked up before the search got past its first
+ *             round
+ **************************************/
+Cell* Planner::getPlan() {
+	pthread_mutex_lock(&_mutex);
+	if (!_running || (!_requested && _state == PLANNER_IDLE)) {
+		pthread_mutex_unlock(&_mutex);
+		return NULL;
+	}
+	_hurry = true;
+	_search->setAbort(true);
+	while (_requested || _state == PLANNER_PLANNING) {
+		pthread_cond_wait(&_cond, &_mutex);
+	}
+	int plan = _plan;
+	GameSearchStats planStats = _planStats;
+	_state = PLANNER_IDLE;
+
+	bool valid = _stillValid();
+	pthread_mutex_unlock(&_mutex);
+
+	if (!valid) {
+		_stats.invalidated++;
+		LOG.write(LOG_MED, "planner", "map changed, planning again");
+		return NULL;
+	}
+	if (plan == -1) {
+		return NULL;
+	}
+	if (planStats.depth <= PLANNER_MIN_DEPTH && !planStats.complete) {
+		_stats.shallow++;
+		LOG.write(LOG_MED, "planner", "plan only searched to depth %d, "
+		          "planning again", planStats.depth);
+		return NULL;
+	}
+	_stats.used++;
+	return _map->cells[plan % MAP_WIDTH][plan / MAP_WIDTH];
+}
+
+/**************************************
+ * Definition: Returns how many plans have been made and used
+ **************************************/
+PlannerStats Planner::getStats() {
+	return _stats;
+}
+
+/**************************************
+ * Definition: Logs how many plans have been made and used
+ **************************************/
+void Planner::logStats() {
+	LOG.write(LOG_MED, "planner", 
+	          "requests: %d used: %d invalidated: %d shallow: %d",
+	          _stats.requests, _stats.used, _stats.invalidated, 
+	          _stats.shallow);
+}
+
+/**************************************
+ * Definition: Notes what the map changed, so getPlan can tell if
+ *             the plan was made on a board that's out of date
+ *
+ * Parameters: the changes
+ **************************************/
+void Planner::mapChanged(MapChanges *changes) {
+	pthread_mutex_lock(&_mutex);
+	_changed |= changes->changed;
+	_opponentMoved = _opponentMoved || changes->opponentMoved;
+	pthread_mutex_unlock(&_mutex);
+}
+
+void* Planner::_run(void *planner) {
+	((Planner *)planner)->_loop();
+	return NULL;
+}
+
+/**************************************
+ * Definition: Waits for a plan to be asked for and makes it. The
+ *             search runs without the lock, on the predicted board,
+ *             which nothing else touches while it's planning.
+ **************************************/
+void Planner::_loop() {
+	pthread_mutex_lock(&_mutex);
+	while (_running) {
+		if (!_requested) {
+			pthread_cond_wait(&_cond, &_mutex);
+			continue;
+		}
+		_requested = false;
+		_state = PLANNER_PLANNING;
+		// if it's already wanted, just finish the first round
+		_search->setAbort(_hurry);
+		pthread_mutex_unlock(&_mutex);
+
+		int plan = _search->search(&_predicted, _us, _them, PLANNER_BUDGET);
+
+		pthread_mutex_lock(&_mutex);
+		_plan = plan;
+		_planStats = _search->getStats();
+		_state = PLANNER_DONE;
+		pthread_cond_broadcast(&_cond);
+	}
+	pthread_mutex_unlock(&_mutex);
+}
+
+/**************************************
+ * Definition: Determines if the map still matches the board the plan
+ *             was made on: we're in the cell it was planned from, and
+ *             since it was asked for the opponent hasn't moved and
+ *             no cell but that one has changed
+ **************************************/
+bool Planner::_stillValid() {
+	Cell *ourCell = _map->getCurrentCell();
+	if (BitBoard::indexOf(ourCell->x, ourCell->y) != _us) {
+		return false;
+	}
+	if (_opponentMoved) {
+		return false;
+	}
+	return (_changed & ~BitBoard::bitAt(_us)) == 0;
+}
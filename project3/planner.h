@@ -0,0 +1,86 @@
+/**
+ * planner.h
+ *
+ * @brief
+ *      This class plans our next move on its own thread while the
+ *      robot is still driving into the cell before it. It searches a
+ *      predicted copy of the board, with us already in that cell (see
+ *      GameSearch::search), and the plan is only used if the map still
+ *      matches the prediction once we get there: if the opponent moved
+ *      or any pellet changed, it's thrown away and planned again.
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#ifndef CS1567_PLANNER_H
+#define CS1567_PLANNER_H
+
+#include "map.h"
+#include "bitboard.h"
+#include "game_search.h"
+
+#include <pthread.h>
+
+#define PLANNER_BUDGET 2.0  // seconds, about the time a move takes
+
+// a plan not searched past this depth (the first round) is no better
+// than the one nextCell would make itself, so it isn't used
+#define PLANNER_MIN_DEPTH 2
+
+#define PLANNER_IDLE 0
+#define PLANNER_PLANNING 1
+#define PLANNER_DONE 2
+
+typedef struct {
+	int requests;
+	int used;           // plans that were still good once we got there
+	int invalidated;    // plans the map had changed under
+	int shallow;        // plans picked up before they got past the
+	                    // first round
+} PlannerStats;
+
+class Planner : public MapListener {
+public:
+	Planner(Map *map);
+	~Planner();
+	bool start();
+	void stop();
+	void planFrom(Cell *cell);
+	bool isPlanning();
+	Cell* getPlan();
+	PlannerStats getStats();
+	void logStats();
+	void mapChanged(MapChanges *changes);
+private:
+	Map *_map;
+	GameSearch *_search;    // its own, only used on the planner thread
+
+	pthread_t _thread;
+	pthread_mutex_t _mutex;
+	pthread_cond_t _cond;
+	bool _running;
+	int _state;             // PLANNER_IDLE, _PLANNING or _DONE
+	bool _requested;        // a plan is waiting to be started
+	bool _hurry;            // the plan is wanted now
+
+	BitBoard _predicted;    // the board once we're in the cell
+	int _us;                // board index of the cell
+	int _them;              // board index of the opponent, -1 if unknown
+	int _plan;              // board index to move to next, -1 if none
+	GameSearchStats _planStats; // how far the search for it got
+
+	uint64_t _changed;      // cells the map changed since planFrom
+	bool _opponentMoved;    // whether it moved them since planFrom
+
+	PlannerStats _stats;
+
+	static void* _run(void *planner);
+	void _loop();
+	bool _stillValid();
+};
+
+#endif
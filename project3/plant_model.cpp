@@ -0,0 +1,234 @@
+/**
+ * plant_model.cpp
+ *
+ * @brief
+ *      This class models how the robot responds to a drive command as
+ *      a first order lag plus dead time, fitted to the step response in
+ *      a recorded north star log. It can then be run to simulate the
+ *      robot (for tuning and replay tests) and gives how far the robot
+ *      keeps going after it's told to stop.
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#include "plant_model.h"
+#include "motion_profile.h"
+#include "utilities.h"
+
+#include <stdio.h>
+#include <math.h>
+#include <string>
+#include <fstream>
+
+// the speed level the step response logs were recorded at
+#define LOG_SPEED_LEVEL 1
+
+PlantModel::PlantModel() {
+    _deadTime = 0.0;
+    _timeConstant = PLANT_SIM_STEP;
+    reset();
+}
+
+PlantModel::PlantModel(float deadTime, float timeConstant) {
+    _deadTime = deadTime;
+    _timeConstant = timeConstant;
+    reset();
+}
+
+PlantModel::~PlantModel() {}
+
+/**************************************
+ * Definition: Fits the model to a step response log and converts it
+ *             from samples to seconds. The logs don't have times, so
+ *             a turning log's sample time is found by matching its
+ *             fitted speed (in radians, unlike north star positions)
+ *             to the speed table at LOG_SPEED_LEVEL, and other logs
+ *             (recorded by the same program) use the same one.
+ *
+ * Parameters: the log, whether it's a turn, and the sample time
+ *             (set when turning, used otherwise)
+ *
+ * Returns:    false if the log couldn't be fit
+ **************************************/
+bool PlantModel::fit(const char *fileName, bool turning, double *sampleTime) {
+    std::vector<double> series = readStep(fileName, turning);
+    double speed;
+    if (!fitStep(series, &_deadTime, &_timeConstant, &speed)) {
+        printf("ERROR: unable to fit a step response to %s\n", fileName);
+        return false;
+    }
+
+    if (turning) {
+        *sampleTime = fabs(speed) / 
+                      MotionProfile::speedForLevel(PROFILE_TURN_LEFT, 
+                                                   LOG_SPEED_LEVEL);
+    }
+    _deadTime *= *sampleTime;
+    _timeConstant *= *sampleTime;
+    reset();
+
+    printf("%s:\n\t%d samples of %.3f s, dead time %.3f s, "
+           "time constant %.3f s\n", fileName, (int)series.size(),
+           *sampleTime, _deadTime, _timeConstant);
+    return true;
+}
+
+float PlantModel::getDeadTime() {
+    return _deadTime;
+}
+
+float PlantModel::getTimeConstant() {
+    return _timeConstant;
+}
+
+/**************************************
+ * Definition: Returns how far the robot goes after being told to
+ *             stop: the dead time at full speed, then the lag
+ *             decaying (which covers speed * time constant)
+ *
+ * Parameters: the speed the robot is going
+ **************************************/
+float PlantModel::getStopDistance(float speed) {
+    return speed * (_deadTime + _timeConstant);
+}
+
+/**************************************
+ * Definition: Puts the simulated robot at rest
+ **************************************/
+void PlantModel::reset() {
+    _velocity = 0;
+    _delaySteps = (int)(_deadTime / PLANT_SIM_STEP + 0.5);
+    if (_delaySteps > PLANT_MAX_DELAY_STEPS - 1) {
+        _delaySteps = PLANT_MAX_DELAY_STEPS - 1;
+    }
+    _head = 0;
+    for (int i = 0; i < PLANT_MAX_DELAY_STEPS; i++) {
+        _delayed[i] = 0;
+    }
+}
+
+/**************************************
+ * Definition: Runs the simulated robot with a constant command
+ *
+ * Parameters: the commanded speed (units/second, signed) and how
+ *             long to run it for
+ *
+ * Returns:    the distance moved
+ **************************************/
+float PlantModel::run(float command, float seconds) {
+    float alpha = PLANT_SIM_STEP / (_timeConstant + PLANT_SIM_STEP);
+    float distance = 0;
+    for (float t = 0; t < seconds - PLANT_SIM_STEP / 2; t += PLANT_SIM_STEP) {
+        _delayed[_head] = command;
+        int tail = (_head + PLANT_MAX_DELAY_STEPS - _delaySteps) %
+                   PLANT_MAX_DELAY_STEPS;
+        _head = (_head + 1) % PLANT_MAX_DELAY_STEPS;
+
+        _velocity += alpha * (_delayed[tail] - _velocity);
+        distance += _velocity * PLANT_SIM_STEP;
+    }
+    return distance;
+}
+
+float PlantModel::getVelocity() {
+    return _velocity;
+}
+
+/**************************************
+ * Definition: Reads a north star log (x, y, theta per sample) of a
+ *             step, taking either the straight line distance from
+ *             the first sample or the (unwrapped) change in theta
+ *
+ * Returns:    the cumulative distance at each sample
+ **************************************/
+std::vector<double> PlantModel::readStep(const char *fileName, bool turning) {
+    std::vector<double> series;
+    std::ifstream file(fileName);
+    std::string line;
+    float startX, startY, lastTheta;
+    double total = 0;
+    while (std::getline(file, line)) {
+        float x, y, theta;
+        if (sscanf(line.c_str(), "%f,%f,%f", &x, &y, &theta) != 3) {
+            continue;
+        }
+        if (series.empty()) {
+            startX = x;
+            startY = y;
+            lastTheta = theta;
+        }
+        if (turning) {
+            total += Util::normalizeThetaError(theta - lastTheta);
+            lastTheta = theta;
+        }
+        else {
+            total = sqrt((x - startX) * (x - startX) + 
+                         (y - startY) * (y - startY));
+        }
+        series.push_back(total);
+    }
+    return series;
+}
+
+/**************************************
+ * Definition: Fits a first order lag plus dead time to a step response
+ *             by searching over the dead time and time constant, with
+ *             the steady speed solved by least squares for each
+ *
+ * Parameters: the cumulative distance at each sample, and where to
+ *             store the dead time and time constant (in samples)
+ *             and the steady speed (per sample)
+ *
+ * Returns:    false if the log is too short or never moved
+ **************************************/
+bool PlantModel::fitStep(std::vector<double> &series, float *deadTime,
+                         float *timeConstant, double *speed) {
+    if (series.size() < 10) {
+        return false;
+    }
+
+    double bestError = -1;
+    for (double dead = 0.0; dead <= 5.0; dead += 0.05) {
+        for (double tau = 0.05; tau <= 5.0; tau += 0.05) {
+            // distance covered by a unit speed step at each sample
+            double sumShapeSquared = 0;
+            double sumShapeSeries = 0;
+            for (size_t k = 0; k < series.size(); k++) {
+                double t = k - dead;
+                double shape = 0;
+                if (t > 0) {
+                    shape = t - tau * (1 - exp(-t / tau));
+                }
+                sumShapeSquared += shape * shape;
+                sumShapeSeries += shape * series[k];
+            }
+            if (sumShapeSquared <= 0) {
+                continue;
+            }
+            double k0 = sumShapeSeries / sumShapeSquared;
+
+            double error = 0;
+            for (size_t k = 0; k < series.size(); k++) {
+                double t = k - dead;
+                double shape = 0;
+                if (t > 0) {
+                    shape = t - tau * (1 - exp(-t / tau));
+                }
+                double residual = series[k] - k0 * shape;
+                error += residual * residual;
+            }
+            if (bestError < 0 || error < bestError) {
+                bestError = error;
+                *deadTime = dead;
+                *timeConstant = tau;
+                *speed = k0;
+            }
+        }
+    }
+
+    return bestError >= 0 && *speed != 0;
+}
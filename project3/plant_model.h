@@ -0,0 +1,52 @@
+/**
+ * plant_model.h
+ *
+ * @brief
+ *      This class models how the robot responds to a drive command as
+ *      a first order lag plus dead time, fitted to the step response in
+ *      a recorded north star log. It can then be run to simulate the
+ *      robot (for tuning and replay tests) and gives how far the robot
+ *      keeps going after it's told to stop.
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#ifndef CS1567_PLANTMODEL_H
+#define CS1567_PLANTMODEL_H
+
+#include <vector>
+
+#define PLANT_SIM_STEP 0.01 // seconds
+#define PLANT_MAX_DELAY_STEPS 256
+
+class PlantModel {
+public:
+    PlantModel();
+    PlantModel(float deadTime, float timeConstant);
+    ~PlantModel();
+    bool fit(const char *fileName, bool turning, double *sampleTime);
+    float getDeadTime();
+    float getTimeConstant();
+    float getStopDistance(float speed);
+    void reset();
+    float run(float command, float seconds);
+    float getVelocity();
+
+    static std::vector<double> readStep(const char *fileName, bool turning);
+    static bool fitStep(std::vector<double> &series, float *deadTime,
+                        float *timeConstant, double *speed);
+private:
+    float _deadTime;        // seconds
+    float _timeConstant;    // seconds
+
+    float _velocity;        // units/second
+    float _delayed[PLANT_MAX_DELAY_STEPS];
+    int _delaySteps;
+    int _head;
+};
+
+#endif
@@ -4,6 +4,11 @@
  * @brief 
  * 		This class is used for keeping the robot's physical pose (x, y, theta) 
  *      and performing calculations on it.
+ *
+ *      Poses are small values (three floats and no destructor), so they
+ *      can be kept on the stack, copied with = and stored in arrays 
+ *      rather than allocated with new. The transforms are inline since 
+ *      they run on every sensor update.
  * 
  * @author
  * 		Shawn Hanna
@@ -17,26 +22,108 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "utilities.h"
 
 class Pose {
 public:
-    Pose(float x, float y, float theta);
-    ~Pose();
-    void reset(float x, float y, float theta);
-    void setX(float x);
-    void setY(float y);
-    void setTheta(float theta);
-	float getX();
-	float getY();
-	float getTheta();
-    void add(float deltaX, float deltaY, float deltaTheta);
+    Pose(float x = 0.0, float y = 0.0, float theta = 0.0) {
+        _x = x;
+        _y = y;
+        _theta = theta;
+    }
+
+    /**************************************
+     * Definition: Resets the current pose according to parameters
+     *
+     * Parameters: a new x, y, and theta
+     **************************************/
+    void reset(float x, float y, float theta) {
+        _x = x;
+        _y = y;
+        setTheta(theta);
+    }
+
+    void setX(float x) { _x = x; }
+    void setY(float y) { _y = y; }
+    void setTheta(float theta) { _theta = Util::normalizeTheta(theta); }
+	float getX() { return _x; }
+	float getY() { return _y; }
+	float getTheta() { return _theta; }
+
+    /**************************************
+     * Definition: Adds deltas to the current pose
+     *
+     * Parameters: delta x, delta y, and delta theta as floats
+     **************************************/
+    void add(float deltaX, float deltaY, float deltaTheta) {
+        _x += deltaX;
+        _y += deltaY;
+        _theta += deltaTheta;
+    }
+
 	void difference(Pose* pose1, Pose* pose2, Pose* destination);
 	float distance(Pose* pose1, Pose* pose2);
-	void rotateEach(float xAngle, float yAngle, float thetaAngle);
-	void rotate(float angle);
-	void scale(float sx, float sy);
-	void translate(float tx, float ty);
-    void toArray(float *arr);
+
+    /**************************************
+     * Definition: Rotates x, y, and theta according to the
+     *             given angles
+     *
+     * Parameters: x angle, y angle, and theta angle as floats
+     **************************************/
+	void rotateEach(float xAngle, float yAngle, float thetaAngle) {
+        float newX = _x * cos(xAngle) - _y * sin(xAngle);
+        float newY = _x * sin(yAngle) + _y * cos(yAngle);
+        _x = newX;
+        _y = newY;
+        setTheta(_theta - thetaAngle);
+    }
+
+    /**************************************
+     * Definition: Rotates x, y, and theta according to the
+     *             given angle
+     *
+     * Parameters: angle as a float
+     **************************************/
+	void rotate(float angle) {
+        float sinAngle = sin(angle);
+        float cosAngle = cos(angle);
+        float newX = _x * cosAngle - _y * sinAngle;
+        float newY = _x * sinAngle + _y * cosAngle;
+        _x = newX;
+        _y = newY;
+        setTheta(_theta - angle);
+    }
+
+    /**************************************
+     * Definition: Scales x and y according to the scaling constants
+     *
+     * Parameters: x and y scaling floats
+     **************************************/
+	void scale(float sx, float sy) {
+        _x /= sx;
+        _y /= sy;
+    }
+
+    /**************************************
+     * Definition: Translates x and y according to translation constants
+     *
+     * Parameters: x and y translation floats
+     **************************************/
+	void translate(float tx, float ty) {
+        _x += tx;
+        _y += ty;
+    }
+
+    /**************************************
+     * Definition: Sets a 3-element array to have x, y, and theta 
+     *
+     * Parameters: pointer to an array
+     **************************************/
+    void toArray(float *arr) {
+        arr[0] = _x;
+        arr[1] = _y;
+        arr[2] = _theta;
+    }
 private:
 	float _x;
 	float _y;
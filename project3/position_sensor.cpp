@@ -18,12 +18,10 @@
 
 PositionSensor::PositionSensor(Robot *robot) {
 	_robot = robot;
-	_pose = new Pose(0.0, 0.0, 0.0);
+	_pose.reset(0.0, 0.0, 0.0);
 }
 
-PositionSensor::~PositionSensor() {
-	delete _pose;
-}
+PositionSensor::~PositionSensor() {}
 
 /**************************************
  * Definition: Sets the stored pose to the given one
@@ -31,9 +29,7 @@ PositionSensor::~PositionSensor() {
  * Parameters: a pose object
  **************************************/
 void PositionSensor::resetPose(Pose *pose) {
-	_pose->setX(pose->getX());
-	_pose->setY(pose->getY());
-	_pose->setTheta(pose->getTheta());
+	_pose = *pose;
 }
 
 /**************************************
@@ -69,9 +65,9 @@ float PositionSensor::getTheta() {
  * Returns:    a pointer to the stored pose
  **************************************/
 Pose* PositionSensor::getPose() {
-	return _pose;
+	return &_pose;
 }
 
 void PositionSensor::setTheta(float theta) {
-	_pose->setTheta(theta);
+	_pose.setTheta(theta);
 }
@@ -32,7 +32,7 @@ public:
 	void setTheta(float theta);
 protected:
 	Robot *_robot;
-	Pose *_pose;
+	Pose _pose;
 };
 
 #endif
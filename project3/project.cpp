@@ -16,7 +16,9 @@
 #include "robot.h"
 #include "logger.h"
 #include "camera.h"
+#include "calibration.h"
 #include <stdio.h>
+#include <signal.h>
 
 int main(int argc, char *argv[]) {
 	if (argc < 2) {
@@ -29,6 +31,9 @@ int main(int argc, char *argv[]) {
 	}
 
     LOG.setImportanceLevel(LOG_LOW);
+
+	// `kill -HUP` reloads the north star calibration files
+	Calibration::watchSignal(SIGHUP);
 	
 	Robot *robot = new Robot(argv[1], atoi(argv[2]));
 
@@ -39,6 +44,8 @@ int main(int argc, char *argv[]) {
 
 	robot->eatShit();
 
+	robot->getTrajectory()->write("logs/trajectory.dat");
+
 	delete robot;
 
 	return 0;
@@ -0,0 +1,155 @@
+/**
+ * rate_scheduler.cpp
+ * 
+ * @brief 
+ *      This class paces a control loop at a fixed rate on the monotonic
+ *      clock. Each tick is scheduled from the start of the loop (not from
+ *      when the last tick finished), so slow ticks don't make the loop
+ *      drift, and ticks that run past their deadline are counted as 
+ *      overruns. It also keeps timing stats for each loop.
+ * 
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#include "rate_scheduler.h"
+#include "utilities.h"
+#include "logger.h"
+#include <errno.h>
+
+#define NSEC_PER_SEC 1000000000L
+
+RateScheduler::RateScheduler(float rate) {
+    setRate(rate);
+    start();
+}
+
+RateScheduler::~RateScheduler() {}
+
+/**************************************
+ * Definition: Sets how many ticks there are per second
+ *
+ * Parameters: float rate in Hz
+ **************************************/
+void RateScheduler::setRate(float rate) {
+    _period = 1.0 / rate;
+}
+
+/**************************************
+ * Definition: Returns the rate in Hz
+ **************************************/
+float RateScheduler::getRate() {
+    return 1.0 / _period;
+}
+
+/**************************************
+ * Definition: Returns the time between ticks in seconds
+ **************************************/
+double RateScheduler::getPeriod() {
+    return _period;
+}
+
+/**************************************
+ * Definition: Starts a new loop, with its first tick now, 
+ *             and clears the stats
+ **************************************/
+void RateScheduler::start() {
+    clock_gettime(CLOCK_MONOTONIC, &_nextTick);
+    _tickStart = _nextTick.tv_sec + (double)_nextTick.tv_nsec / NSEC_PER_SEC;
+
+    _stats.ticks = 0;
+    _stats.overruns = 0;
+    _stats.missedTicks = 0;
+    _stats.minWork = 0.0;
+    _stats.maxWork = 0.0;
+    _stats.totalWork = 0.0;
+    _stats.maxLateness = 0.0;
+}
+
+/**************************************
+ * Definition: Ends the current tick and sleeps until the next one
+ *             is due. If the tick's work already ran past the next
+ *             deadline, the missed deadlines are skipped rather than
+ *             run back to back.
+ *
+ * Returns:    false if this tick overran
+ **************************************/
+bool RateScheduler::waitForTick() {
+    double now = Util::getTime();
+    double work = now - _tickStart;
+    if (_stats.ticks == 0 || work < _stats.minWork) {
+        _stats.minWork = work;
+    }
+    if (work > _stats.maxWork) {
+        _stats.maxWork = work;
+    }
+    _stats.totalWork += work;
+    _stats.ticks++;
+
+    long periodNsec = (long)(_period * NSEC_PER_SEC);
+    double next = 0.0;
+    int missed = -1;
+    do {
+        _nextTick.tv_nsec += periodNsec;
+        while (_nextTick.tv_nsec >= NSEC_PER_SEC) {
+            _nextTick.tv_nsec -= NSEC_PER_SEC;
+            _nextTick.tv_sec++;
+        }
+        next = _nextTick.tv_sec + (double)_nextTick.tv_nsec / NSEC_PER_SEC;
+        missed++;
+    } while (next < now);
+
+    if (missed > 0) {
+        _stats.overruns++;
+        _stats.missedTicks += missed;
+        LOG.write(LOG_LOW, "rate_scheduler", 
+                  "tick %d overran: %f s of work for a %f s period", 
+                  _stats.ticks, work, _period);
+    }
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, 
+                           &_nextTick, NULL) == EINTR) {}
+
+    _tickStart = Util::getTime();
+    if (_tickStart - next > _stats.maxLateness) {
+        _stats.maxLateness = _tickStart - next;
+    }
+    return missed == 0;
+}
+
+/**************************************
+ * Definition: Returns when the current tick started
+ *
+ * Returns:    monotonic time in seconds (see Util::getTime)
+ **************************************/
+double RateScheduler::getTickTime() {
+    return _tickStart;
+}
+
+/**************************************
+ * Definition: Returns the timing stats since the loop started
+ **************************************/
+RateStats* RateScheduler::getStats() {
+    return &_stats;
+}
+
+/**************************************
+ * Definition: Logs the timing stats since the loop started
+ *
+ * Parameters: string naming the loop in the log
+ **************************************/
+void RateScheduler::logStats(std::string name) {
+    if (_stats.ticks == 0) {
+        return;
+    }
+    LOG.write(LOG_MED, "control_timing", 
+              "%s: %d ticks at %f Hz, %d overruns (%d ticks missed), "
+              "work min/mean/max: %f/%f/%f s, max lateness: %f s",
+              name.c_str(), _stats.ticks, getRate(), _stats.overruns, 
+              _stats.missedTicks, _stats.minWork, 
+              _stats.totalWork / _stats.ticks, _stats.maxWork, 
+              _stats.maxLateness);
+}
@@ -0,0 +1,53 @@
+/**
+ * rate_scheduler.h
+ * 
+ * @brief 
+ *      This class paces a control loop at a fixed rate on the monotonic
+ *      clock. Each tick is scheduled from the start of the loop (not from
+ *      when the last tick finished), so slow ticks don't make the loop
+ *      drift, and ticks that run past their deadline are counted as 
+ *      overruns. It also keeps timing stats for each loop.
+ * 
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#ifndef CS1567_RATESCHEDULER_H
+#define CS1567_RATESCHEDULER_H
+
+#include <string>
+#include <time.h>
+
+typedef struct {
+    int ticks;
+    int overruns;       // ticks whose work ran past the next deadline
+    int missedTicks;    // deadlines skipped because of overruns
+    double minWork;     // seconds spent working in a tick
+    double maxWork;
+    double totalWork;
+    double maxLateness; // seconds we woke up after a deadline
+} RateStats;
+
+class RateScheduler {
+public:
+    RateScheduler(float rate);
+    ~RateScheduler();
+    void setRate(float rate);
+    float getRate();
+    double getPeriod();
+    void start();
+    bool waitForTick();
+    double getTickTime();
+    RateStats* getStats();
+    void logStats(std::string name);
+private:
+    double _period;
+    struct timespec _nextTick;
+    double _tickStart;
+    RateStats _stats;
+};
+
+#endif
@@ -14,6 +14,7 @@
  **/
 
 #include "robot.h"
+#include "stop_model.h"
 #include "phrases.h"
 #include "logger.h"
 #include <math.h>
@@ -28,13 +29,28 @@ Robot::Robot(std::string address, int id) {
     _movingForward = true;
     _speed = 0;
     _heading = DIR_NORTH;
+    _command = RI_STOP;
+    _commandSpeed = 0;
 
     setFailLimit(MAX_UPDATE_FAILS);
 
+    _controlLoop = new RateScheduler(CONTROL_RATE);
+    _motionQueue = new MotionQueue();
+    _moveProfile = new MotionProfile(PROFILE_FORWARD, PROFILE_FORWARD_ACCEL);
+    _turnProfile = new MotionProfile(PROFILE_TURN_LEFT, PROFILE_TURN_ACCEL);
+
     _robotInterface = new RobotInterface(address, id);
 
     printf("robot interface loaded\n");
 
+    // poll the robot on its own thread from here on
+    _sensorThread = new SensorThread(_robotInterface);
+    _sensorThread->start();
+    _sensorThread->waitForUpdate();
+    _sensorThread->getSnapshot(&_snapshot);
+
+    printf("sensor thread started\n");
+
     // initialize camera
     _camera = new Camera(_robotInterface);
 
@@ -43,9 +59,9 @@ Robot::Robot(std::string address, int id) {
     _northStar = new NorthStar(this);
     
     // initialize global pose
-    _pose = new Pose(0.0, 0.0, 0.0);
+    _pose.reset(0.0, 0.0, 0.0);
     // bind _pose to the kalman filter
-    _kalmanFilter = new KalmanFilter(_pose);
+    _kalmanFilter = new KalmanFilter(&_pose);
     _kalmanFilter->setUncertainty(PROC_X_UNCERTAIN,
                                   PROC_Y_UNCERTAIN,
                                   PROC_THETA_UNCERTAIN,
@@ -58,20 +74,25 @@ Robot::Robot(std::string address, int id) {
 
     printf("kalman filter initialized\n");
 
-    PIDConstants movePIDConstants = {PID_MOVE_KP, PID_MOVE_KI, PID_MOVE_KD};
-    PIDConstants turnPIDConstants = {PID_TURN_KP, PID_TURN_KI, PID_TURN_KD};
-    PIDConstants centerTurnPIDConstants = {PID_CENTERTURN_KP, PID_CENTERTURN_KI, PID_CENTERTURN_KD};
-    PIDConstants centerStrafePIDConstants = {PID_CENTERSTRAFE_KP, PID_CENTERSTRAFE_KI, PID_CENTERSTRAFE_KD};
+    // use this robot's tuned gains if it has any (see data/tune_pid.cpp)
+    PIDGains gains;
+    gains.load(PIDGains::fileNameFor(_name));
 
-    _movePID = new PID(&movePIDConstants, MIN_MOVE_ERROR, MAX_MOVE_ERROR);
-    _turnPID = new PID(&turnPIDConstants, MIN_TURN_ERROR, MAX_TURN_ERROR);
-    _centerTurnPID = new PID(&centerTurnPIDConstants, MIN_CENTERTURN_ERROR, MAX_CENTERTURN_ERROR);
-    _centerStrafePID = new PID(&centerStrafePIDConstants, MIN_CENTERSTRAFE_ERROR, MAX_CENTERSTRAFE_ERROR);
+    _movePID = new PID(gains.get(PID_LOOP_MOVE), MIN_MOVE_ERROR, MAX_MOVE_ERROR);
+    _turnPID = new PID(gains.get(PID_LOOP_TURN), MIN_TURN_ERROR, MAX_TURN_ERROR);
+    _centerTurnPID = new PID(gains.get(PID_LOOP_CENTERTURN), MIN_CENTERTURN_ERROR, MAX_CENTERTURN_ERROR);
+    _centerStrafePID = new PID(gains.get(PID_LOOP_CENTERSTRAFE), MIN_CENTERSTRAFE_ERROR, MAX_CENTERSTRAFE_ERROR);
 
     printf("pid controllers initialized\n");
+
+    _stopModel = new StopModel();
+    _stopModel->load(StopModel::fileNameFor(_name));
     
     // Put robot head down for NorthStar use
-    _robotInterface->Move(RI_HEAD_DOWN, 1);
+    {
+        InterfaceLock lock;
+        _robotInterface->Move(RI_HEAD_DOWN, 1);
+    }
     sleep(2);
 
     // fill our sensors with data
@@ -87,7 +108,7 @@ Robot::Robot(std::string address, int id) {
     // system, so we can know what cell we started at
     int startingX;
     int startingY;
-    if (_pose->getX() > 150) {
+    if (_pose.getX() > 150) {
         startingX = 0;
         startingY = 2;
     }
@@ -101,18 +122,25 @@ Robot::Robot(std::string address, int id) {
 }
 
 Robot::~Robot() {
+    // stop polling before the interface goes away
+    delete _sensorThread;
     delete _robotInterface;
     delete _camera;
     delete _wheelEncoders;
     delete _northStar;
-    delete _pose;
     delete _kalmanFilter;
+    delete _controlLoop;
+    delete _motionQueue;
+    delete _moveProfile;
+    delete _turnProfile;
     delete _movePID;
     delete _turnPID;
     delete _centerTurnPID;
     delete _centerStrafePID;
-    delete _map;
+    delete _stopModel;
+    // the strategy's planner listens to the map
     delete _mapStrategy;
+    delete _map;
 }
 
 /**************************************
@@ -121,34 +149,219 @@ Robot::~Robot() {
  * 				and perform the 'move' function in the desired direction
  *************************************/
 void Robot::eatShit() {
-    Cell *nextCell = _mapStrategy->nextCell();
-	sleep(10);
+    Cell *nextCell = _mapStrategy->nextCell(NEXT_CELL_BUDGET, _heading);
+    MotionHandle motion = MOTION_NONE;
 
     while (nextCell != NULL) {
-        Cell *curCell = _map->getCurrentCell();
-
-        int xDiff = nextCell->x - curCell->x;
-        int yDiff = nextCell->y - curCell->y;
-
-        // TODO: make sure these match up with proper cardinal
-        // directions
-        if (xDiff > 0) {
-            move(DIR_WEST, 1);
+        int direction = _directionTo(nextCell);
+
+        // changing direction means stopping to turn, so finish the
+        // cell we're in and center before heading off
+        if (direction != _heading || _motionQueue->isEmpty()) {
+            waitForMotion(motion);
+            stop();
+            turn(direction);
+            _heading = direction;
+            center();
+            updatePose(true);
         }
-        else if (xDiff < 0) {
-            move(DIR_EAST, 1);
+
+        MotionHandle queued = moveAsync(direction, 1);
+        if (queued == MOTION_NONE) {
+            LOG.write(LOG_HIGH, "eatShit", "unable to queue move");
+            break;
         }
-        else if (yDiff > 0) {
-            move(DIR_NORTH, 1);
+        motion = queued;
+        _mapStrategy->planFrom(nextCell);
+
+        // finish the cell we're leaving, until the move into the next
+        // one has started
+        _controlLoop->start();
+        while (_motionQueue->getStatus(motion) == MOTION_PENDING) {
+            serviceMotion();
         }
-        else if (yDiff < 0) {
-            move(DIR_SOUTH, 1);
+
+        // drive until we're nearly into the cell, then plan the next
+        // one while we're still moving so it can be queued up behind
+        // this one without stopping
+        while (!motionDone(motion) && 
+               _motionQueue->getRemaining(motion) > CELL_BLEND_DISTANCE) {
+            serviceMotion();
         }
 
+        // we're in the cell now, so pick the next one quickly unless
+        // we've already stopped
         _map->occupyCell(nextCell->x, nextCell->y);
-		nextCell = _mapStrategy->nextCell();
-		sleep(10);
+        double budget = motionDone(motion) ? NEXT_CELL_BUDGET 
+                                           : NEXT_CELL_MOVING_BUDGET;
+        nextCell = _mapStrategy->nextCell(budget, _heading);
+    }
+
+    waitForMotion(motion);
+    stop();
+}
+
+/**************************************
+ * Definition: Returns the direction to move in to get from the
+ *             current cell to a neighbouring one
+ *
+ * Parameters: pointer to the neighbouring cell
+ *
+ * Returns:    int specifying the direction (DIR_NORTH, ...)
+ **************************************/
+int Robot::_directionTo(Cell *cell) {
+    Cell *curCell = _map->getCurrentCell();
+
+    int xDiff = cell->x - curCell->x;
+    int yDiff = cell->y - curCell->y;
+
+    // TODO: make sure these match up with proper cardinal
+    // directions
+    if (xDiff > 0) {
+        return DIR_WEST;
+    }
+    else if (xDiff < 0) {
+        return DIR_EAST;
+    }
+    else if (yDiff > 0) {
+        return DIR_NORTH;
+    }
+    return DIR_SOUTH;
+}
+
+/**************************************
+ * Definition: Returns the global theta for a direction
+ *
+ * Parameters: int specifying the direction (DIR_NORTH, ...)
+ **************************************/
+float Robot::_thetaFor(int direction) {
+    switch (direction) {
+    case DIR_NORTH:
+        return DEGREE_90;
+    case DIR_SOUTH:
+        return DEGREE_270;
+    case DIR_WEST:
+        return DEGREE_180;
     }
+    return DEGREE_0;
+}
+
+/**************************************
+ * Definition: Queues up a move in the specified direction the
+ *             specified number of cells and returns right away.
+ *             Moves queued back to back run without stopping.
+ *
+ * Parameters: ints specifying direction and number of cells
+ *
+ * Returns:    a handle to poll (motionDone) or wait on (waitForMotion)
+ **************************************/
+MotionHandle Robot::moveAsync(int direction, int numCells) {
+    MotionSegment segment;
+    segment.command = RI_MOVE_FORWARD;
+    segment.speed = CELL_SPEED;
+    segment.heading = _thetaFor(direction);
+    segment.duration = 0.0;
+    segment.distance = CELL_SIZE * numCells;
+    return submitMotion(&segment);
+}
+
+/**************************************
+ * Definition: Queues up a motion segment and returns right away
+ *
+ * Parameters: pointer to the segment
+ *
+ * Returns:    a handle to poll (motionDone) or wait on (waitForMotion)
+ **************************************/
+MotionHandle Robot::submitMotion(MotionSegment *segment) {
+    return _motionQueue->submit(segment);
+}
+
+/**************************************
+ * Definition: Returns true once a queued motion has finished
+ *
+ * Parameters: the motion's handle
+ **************************************/
+bool Robot::motionDone(MotionHandle handle) {
+    return _motionQueue->isDone(handle);
+}
+
+/**************************************
+ * Definition: Runs the control loop until a queued motion has
+ *             finished. Motions queued after it keep going.
+ *
+ * Parameters: the motion's handle
+ **************************************/
+void Robot::waitForMotion(MotionHandle handle) {
+    _controlLoop->start();
+    while (!motionDone(handle)) {
+        serviceMotion();
+    }
+    _controlLoop->logStats("waitForMotion");
+}
+
+/**************************************
+ * Definition: Runs one control tick of the motion queue: updates
+ *             the pose, sends the active segment's command and 
+ *             waits for the next tick
+ **************************************/
+void Robot::serviceMotion() {
+    updatePose(true);
+
+    int command;
+    int speed;
+    _motionQueue->service(&_pose, Util::getTime(), &command, &speed);
+    if (command != RI_STOP) {
+        speed = _linkSpeed(speed);
+        if (speed == 0) {
+            command = RI_STOP;
+        }
+    }
+    _send(command, speed);
+
+    _controlLoop->waitForTick();
+}
+
+/**************************************
+ * Definition: Sends a robot interface command through the matching
+ *             movement method, so the speed used for predictions
+ *             is kept up to date
+ *
+ * Parameters: the command (ie, RI_TURN_LEFT) and speed
+ **************************************/
+void Robot::_send(int command, int speed) {
+    switch (command) {
+    case RI_MOVE_FORWARD:
+        moveForward(speed);
+        break;
+    case RI_TURN_LEFT:
+        turnLeft(speed);
+        break;
+    case RI_TURN_RIGHT:
+        turnRight(speed);
+        break;
+    case RI_MOVE_LEFT:
+        strafeLeft(speed);
+        break;
+    case RI_MOVE_RIGHT:
+        strafeRight(speed);
+        break;
+    case RI_STOP:
+        if (_command != RI_STOP) {
+            stop();
+        }
+        break;
+    default:
+        _drive(command, speed);
+        break;
+    }
+}
+
+/**************************************
+ * Definition: Drops every queued motion and stops the robot
+ **************************************/
+void Robot::cancelMotion() {
+    _motionQueue->cancel();
+    stop();
 }
 
 /**************************************
@@ -173,8 +386,8 @@ void Robot::move(int direction, int numCells) {
         center();
 		updatePose(true);
         // based on the direction, move in the global coord system
-        float goalX = _pose->getX();
-        float goalY = _pose->getY();
+        float goalX = _pose.getX();
+        float goalY = _pose.getY();
         switch (direction) {
         case DIR_NORTH:
             goalY += CELL_SIZE;
@@ -191,7 +404,6 @@ void Robot::move(int direction, int numCells) {
         }
         moveTo(goalX, goalY); // was moveToCell
 		stop();
-		usleep(5000000);
         cellsTraveled++;
         LOG.write(LOG_LOW, "move", "Made it to cell %d", cellsTraveled);
     }
@@ -327,7 +539,7 @@ void Robot::turn(int relDirection, float radians) {
 void Robot::moveToCell(float x, float y) {
     LOG.write(LOG_LOW, "moveToCell", 
               "moveToCell cur. location: %f, %f, %f", 
-              _pose->getX(), _pose->getY(), _northStar->getTheta());
+              _pose.getX(), _pose.getY(), _northStar->getTheta());
 
     printf("beginning move to cell at (%f, %f)\n", x, y);
 
@@ -348,7 +560,7 @@ void Robot::moveToCell(float x, float y) {
     _turnPID->flushPID();
 
     // reset wheel encoder pose to be Kalman pose since we hit our base
-    _wheelEncoders->resetPose(_pose);
+    _wheelEncoders->resetPose(&_pose);
 }
 
 /**************************************
@@ -375,7 +587,7 @@ void Robot::moveTo(float x, float y) {
     _turnPID->flushPID();
 
     // reset wheel encoder pose to be Kalman pose since we hit our base
-    _wheelEncoders->resetPose(_pose);
+    _wheelEncoders->resetPose(&_pose);
 }
 
 /**************************************
@@ -396,7 +608,14 @@ float Robot::moveToUntil(float x, float y, float thetaErrorLimit) {
     float moveGain;
 
     printf("heading toward (%f, %f)\n", x, y);
+    _controlLoop->start();
+    _moveProfile->start(_controlLoop->getTickTime());
+    double lastTick = _controlLoop->getTickTime() - _controlLoop->getPeriod();
     do {
+        double tick = _controlLoop->getTickTime();
+        float dt = tick - lastTick;
+        lastTick = tick;
+
         updatePose(true);
 
         LOG.write(LOG_HIGH, "move_we_pose",
@@ -411,29 +630,29 @@ float Robot::moveToUntil(float x, float y, float thetaErrorLimit) {
                   _northStar->getPose()->getTheta()); 
         LOG.write(LOG_HIGH, "move_kalman_pose",
                   "x: %f \t y: %f \t theta: %f", 
-                  _pose->getX(),
-                  _pose->getY(),
-                  _pose->getTheta()); 
+                  _pose.getX(),
+                  _pose.getY(),
+                  _pose.getTheta()); 
 
-        yError = y - _pose->getY();
-        xError = x - _pose->getX();
+        yError = y - _pose.getY();
+        xError = x - _pose.getX();
 
         switch (_heading) {
         case DIR_NORTH:
             thetaDesired = DEGREE_90;
-            distError = fabs(y - _pose->getY());
+            distError = fabs(y - _pose.getY());
             break;
         case DIR_SOUTH:
             thetaDesired = DEGREE_270;
-            distError = fabs(y - _pose->getY());
+            distError = fabs(y - _pose.getY());
             break;
         case DIR_EAST:
             thetaDesired = DEGREE_0;
-            distError = fabs(x - _pose->getX());
+            distError = fabs(x - _pose.getX());
             break;
         case DIR_WEST:
             thetaDesired = DEGREE_180;
-            distError = fabs(x - _pose->getX());
+            distError = fabs(x - _pose.getX());
             break;
         }
 
@@ -457,23 +676,53 @@ float Robot::moveToUntil(float x, float y, float thetaErrorLimit) {
                   thetaError,
                   thetaDesired);
 
-        moveGain = _movePID->updatePID(distError);
-        _turnPID->updatePID(thetaError);
+        moveGain = _movePID->updatePID(distError, dt);
+        _turnPID->updatePID(thetaError, dt);
 
         LOG.write(LOG_LOW, "move_gain", "move gain: %f", moveGain);
 
         if (fabs(thetaError) > thetaErrorLimit) {
 			printf("theta error of %f too great\n", thetaError);
+            _controlLoop->logStats("moveToUntil");
             return thetaError;
         }
-        int moveSpeed = (int)(10 - 9 * moveGain);
-        moveSpeed = Util::capSpeed(moveSpeed, 10);
+        int moveSpeed;
+        if (USE_MOTION_PROFILE) {
+            moveSpeed = _moveProfile->getSpeedLevel(distError, 
+                                                    _controlLoop->getTickTime());
+        }
+        else {
+            moveSpeed = (int)(10 - 9 * moveGain);
+            moveSpeed = Util::capSpeed(moveSpeed, 10);
+        }
 
+        moveSpeed = _linkSpeed(moveSpeed);
         LOG.write(LOG_MED, "pid_speeds", "forward speed: %d", moveSpeed);
 
-        moveForward(moveSpeed);
+        // stop early enough that coasting takes us the rest of the way
+        int currentSpeed = _speed;
+        float stopDistance = _stopModel->getStopDistance(currentSpeed);
+        if (USE_STOP_MODEL && _movingForward && distError <= stopDistance) {
+            LOG.write(LOG_MED, "move_stop", 
+                      "distance err: %f \t stop distance at speed %d: %f",
+                      distError, currentSpeed, stopDistance);
+            stop();
+            _controlLoop->logStats("moveToUntil");
+            _runFor(_stopModel->getSettleTime(currentSpeed), true);
+            return 0;
+        }
+
+        if (moveSpeed == 0) {
+            // close enough to coast the rest of the way
+            stop();
+        }
+        else {
+            moveForward(moveSpeed);
+        }
+        _controlLoop->waitForTick();
     } while (distError > MAX_DIST_ERROR);
 
+    _controlLoop->logStats("moveToUntil");
     return 0; // no error when we've finished
 }
 
@@ -489,10 +738,18 @@ void Robot::turnTo(float thetaGoal, float thetaErrorLimit) {
     float thetaError;
 
     float turnGain;
+    int turnSpeed;
  
     printf("adjusting theta\n");
+    _controlLoop->start();
+    _turnProfile->start(_controlLoop->getTickTime());
+    double lastTick = _controlLoop->getTickTime() - _controlLoop->getPeriod();
     do {
-	updatePose(false);
+        double tick = _controlLoop->getTickTime();
+        float dt = tick - lastTick;
+        lastTick = tick;
+
+        updatePose(false);
 
         LOG.write(LOG_LOW, "turn_we_pose",
                   "x: %f \t y: %f \t theta: %f", 
@@ -506,9 +763,9 @@ void Robot::turnTo(float thetaGoal, float thetaErrorLimit) {
                   _northStar->getPose()->getTheta()); 
         LOG.write(LOG_LOW, "turn_kalman_pose",
                   "x: %f \t y: %f \t theta: %f", 
-                  _pose->getX(),
-                  _pose->getY(),
-                  _pose->getTheta()); 
+                  _pose.getX(),
+                  _pose.getY(),
+                  _pose.getTheta()); 
 
         theta = _northStar->getTheta();
         thetaError = thetaGoal - theta;
@@ -519,32 +776,61 @@ void Robot::turnTo(float thetaGoal, float thetaErrorLimit) {
                   thetaError,
                   thetaGoal);
 
-        turnGain = _turnPID->updatePID(thetaError);
+        turnGain = _turnPID->updatePID(thetaError, dt);
 
         LOG.write(LOG_LOW, "turn_gain", "turn gain: %f", turnGain);
 
         if (thetaError < -thetaErrorLimit) {
             LOG.write(LOG_MED, "turn_adjust", 
                       "direction: right, since theta error < -limit");
-            int turnSpeed = (int)(10 - 9 * turnGain);
-            turnSpeed = Util::capSpeed(turnSpeed, 10);
+            if (USE_MOTION_PROFILE) {
+                _turnProfile->setType(PROFILE_TURN_RIGHT);
+                turnSpeed = _turnProfile->getSpeedLevel(fabs(thetaError), 
+                                                        _controlLoop->getTickTime());
+            }
+            else {
+                turnSpeed = (int)(10 - 9 * turnGain);
+                turnSpeed = Util::capSpeed(turnSpeed, 10);
+            }
 
+            turnSpeed = _linkSpeed(turnSpeed);
             LOG.write(LOG_MED, "pid_speeds", "turn speed: %d", turnSpeed);
 
-            turnRight(turnSpeed);
+            if (turnSpeed == 0) {
+                stop();
+            }
+            else {
+                turnRight(turnSpeed);
+            }
         }
         else if(thetaError > thetaErrorLimit){
             LOG.write(LOG_MED, "turn_adjust", 
                       "direction: left, since theta error > limit");
-            int turnSpeed = (int)(10 - 9 * turnGain);
-            turnSpeed = Util::capSpeed(turnSpeed, 10);
+            if (USE_MOTION_PROFILE) {
+                _turnProfile->setType(PROFILE_TURN_LEFT);
+                turnSpeed = _turnProfile->getSpeedLevel(fabs(thetaError), 
+                                                        _controlLoop->getTickTime());
+            }
+            else {
+                turnSpeed = (int)(10 - 9 * turnGain);
+                turnSpeed = Util::capSpeed(turnSpeed, 10);
+            }
 
+            turnSpeed = _linkSpeed(turnSpeed);
             LOG.write(LOG_MED, "pid_speeds", "turn speed: %d", turnSpeed);
 
-            turnLeft(turnSpeed);
+            if (turnSpeed == 0) {
+                stop();
+            }
+            else {
+                turnLeft(turnSpeed);
+            }
         }
+        _controlLoop->waitForTick();
     } while (fabs(thetaError) > thetaErrorLimit);
 
+    stop();
+    _controlLoop->logStats("turnTo");
 
     printf("theta acceptable\n");
 }
@@ -553,19 +839,40 @@ void Robot::turnTo(float thetaGoal, float thetaErrorLimit) {
  * Definition: Moves the robot head (camera) to the position given as the argument
  * *****************************/
 void Robot::moveHead(int position){
-    _robotInterface->Move(position, 1);
+    {
+        InterfaceLock lock;
+        _robotInterface->Move(position, 1);
+    }
     sleep(1);
-    _robotInterface->Move(position, 1);
+    {
+        InterfaceLock lock;
+        _robotInterface->Move(position, 1);
+    }
     sleep(2);
 }
 
-bool Robot::_centerTurn(float centerError) {
+/**************************************
+ * Definition: Works out the turn that corrects a center error,
+ *             without moving
+ *
+ * Parameters: the center error and a segment to store the turn in
+ *             (its command is RI_STOP if no turn is needed)
+ *
+ * Returns:    true if we're close enough to centered already
+ **************************************/
+bool Robot::_centerTurn(float centerError, MotionSegment *turn) {
     bool success;
 
     float centerTurnGain = _centerTurnPID->updatePID(centerError);
     LOG.write(LOG_LOW, "centerTurn", "center error: %f", centerError);
     LOG.write(LOG_LOW, "centerTurn", "center turn gain: %f", centerTurnGain);
 
+    turn->command = RI_STOP;
+    turn->speed = 0;
+    turn->heading = MOTION_NO_HEADING;
+    turn->duration = 0.0;
+    turn->distance = 0.0;
+
     if (fabs(centerError) < MAX_TURN_CENTER_ERROR) {
         success = true;
         // we're close enough to centered, so stop adjusting
@@ -581,59 +888,50 @@ bool Robot::_centerTurn(float centerError) {
         
         LOG.write(LOG_LOW, "pid_speeds", "turn speed: %d", turnSpeed);
 
+        // slower speeds turn at SLOWEST_TURN_SPEED for less time instead
+        double turnLength = 0.3;
+        if (turnSpeed > SLOWEST_TURN_SPEED) {
+            turnLength -= 0.05 * (turnSpeed - SLOWEST_TURN_SPEED);
+            turnSpeed = SLOWEST_TURN_SPEED;
+        }
+
         if (centerError < 0) {
             LOG.write(LOG_LOW, "centerTurn", "Center error: %f, move right", centerError);
-            turnRight(turnSpeed);
+            turn->command = RI_TURN_RIGHT;
         }
         else {
             LOG.write(LOG_LOW, "centerTurn", "Center error: %f, move left", centerError);
-            turnLeft(turnSpeed);
+            turn->command = RI_TURN_LEFT;
         }
-
-        // make sure we haven't turned beyond 45 degrees (our max adjustment)
-        /*updatePose();
-
-        float thetaHeading;
-        switch (_heading) {
-        case DIR_NORTH:
-            thetaHeading = DEGREE_90;
-            break;
-        case DIR_SOUTH:
-            thetaHeading = DEGREE_270;
-            break;
-        case DIR_EAST:
-            thetaHeading = DEGREE_0;
-            break;
-        case DIR_WEST:
-            thetaHeading = DEGREE_180;
-            break;
-        }
-
-        float theta = _pose->getTheta();
-        float thetaError = thetaHeading - theta;
-        thetaError = Util::normalizeThetaError(thetaError);
-        if (fabs(thetaError) > DEGREE_45) {
-            // if we turned beyond 45 degrees from our
-            // heading, this was a mistake. let's turn
-            // back just enough so we're 45 degrees from
-            // our heading.
-            float thetaGoal = Util::normalizeTheta(theta + (DEGREE_45 + thetaError));
-            turnTo(thetaGoal, MAX_THETA_ERROR);
-        }*/
-
-        _robotInterface->reset_state();
+        turn->speed = turnSpeed;
+        turn->duration = turnLength;
     }
 
     return success;
 }
 
-bool Robot::_centerStrafe(float centerError) {
+/**************************************
+ * Definition: Works out the strafe that corrects a center error,
+ *             without moving
+ *
+ * Parameters: the center error and a segment to store the strafe in
+ *             (its command is RI_STOP if no strafe is needed)
+ *
+ * Returns:    true if we're close enough to centered already
+ **************************************/
+bool Robot::_centerStrafe(float centerError, MotionSegment *strafe) {
     bool success;
 
     float centerStrafeGain = _centerStrafePID->updatePID(centerError);
     LOG.write(LOG_LOW, "centerStrafe", "center error: %f", centerError);
     LOG.write(LOG_LOW, "centerStrafe", "center strafe gain: %f", centerStrafeGain);
 
+    strafe->command = RI_STOP;
+    strafe->speed = 0;
+    strafe->heading = MOTION_NO_HEADING;
+    strafe->duration = 0.0;
+    strafe->distance = 0.0;
+
     if (fabs(centerError) < MAX_STRAFE_CENTER_ERROR) {
         success = true;
         // we're close enough to centered, so stop adjusting
@@ -651,48 +949,78 @@ bool Robot::_centerStrafe(float centerError) {
 
         if (centerError < 0) {
             LOG.write(LOG_LOW, "centerStrafe", "Center error: %f, move right", centerError);
-            strafeRight(strafeSpeed);
+            strafe->command = RI_MOVE_RIGHT;
         }
         else {
             LOG.write(LOG_LOW, "centerStrafe", "Center error: %f, move left", centerError);
-            strafeLeft(strafeSpeed);
+            strafe->command = RI_MOVE_LEFT;
         }
-
-        // we moved, so reset the wheel encoders to ignore
-        // this movement
-        _robotInterface->reset_state();
+        // the strafe is always sent at speed 10, so slower speeds
+        // strafe for less time. the wheel encoders pick it up as we go
+        strafe->speed = strafeSpeed;
+        strafe->duration = 0.5 - 0.045 * strafeSpeed;
     }
 
     return success;
 }
 
+/**************************************
+ * Definition: Runs a turn and a strafe as one correction, before
+ *             the next camera pass. The robot can't do both in a
+ *             single command, so each control tick goes to whichever
+ *             one has more time left, which spreads them across the 
+ *             same window instead of doing one after the other.
+ *
+ * Parameters: the turn and strafe segments (either can be RI_STOP)
+ **************************************/
+void Robot::_centerBoth(MotionSegment *turn, MotionSegment *strafe) {
+    double turnLeft = turn->command == RI_STOP ? 0.0 : turn->duration;
+    double strafeLeft = strafe->command == RI_STOP ? 0.0 : strafe->duration;
+
+    LOG.write(LOG_LOW, "center", "turn for %f s, strafe for %f s", 
+              turnLeft, strafeLeft);
+
+    double period = _controlLoop->getPeriod();
+    _controlLoop->start();
+    while (turnLeft > 0.0 || strafeLeft > 0.0) {
+        updatePose(true);
+        if (turnLeft >= strafeLeft) {
+            _send(turn->command, turn->speed);
+            turnLeft -= period;
+        }
+        else {
+            _send(strafe->command, strafe->speed);
+            strafeLeft -= period;
+        }
+        _controlLoop->waitForTick();
+    }
+    stop();
+}
+
 /**************************************
  * Definition: Strafes the robot until it is considered centered
  *             between two squares in a corridor
  **************************************/
 void Robot::center() {
-    _robotInterface->Move(RI_HEAD_MIDDLE, 1);
-    sleep(1);
-    _robotInterface->Move(RI_HEAD_MIDDLE, 1);
-    sleep(2);
+    moveHead(RI_HEAD_MIDDLE);
 	
 	int attempts = 0;
 
     Camera::prevTagState = -1;
     while (true) {
-        bool turn = false;
-
-        float centerError = _camera->centerError(COLOR_PINK, &turn);
-        if (turn) {
-            if (_centerTurn(centerError)) {
-                break;
-            }
-        }
-        else {
-            if (_centerStrafe(centerError)) {
-                break;
-            }
+        float turnError;
+        float strafeError;
+        _camera->centerErrors(COLOR_PINK, &turnError, &strafeError);
+
+        // correct both at once, so one camera pass can fix both
+        MotionSegment turn;
+        MotionSegment strafe;
+        bool turnCentered = _centerTurn(turnError, &turn);
+        bool strafeCentered = _centerStrafe(strafeError, &strafe);
+        if (turnCentered && strafeCentered) {
+            break;
         }
+        _centerBoth(&turn, &strafe);
         attempts++;
         
         if(attempts > 1){
@@ -717,7 +1045,7 @@ void Robot::center() {
 				break;
 			}
 
-			float theta = _pose->getTheta();
+			float theta = _pose.getTheta();
 			float thetaError = thetaHeading - theta;
 			thetaError = Util::normalizeThetaError(thetaError);
 			if (fabs(thetaError) > DEGREE_45) {
@@ -732,10 +1060,8 @@ void Robot::center() {
 		}
     }
 
-    _robotInterface->Move(RI_HEAD_DOWN, 1);
-    sleep(1);
-    _robotInterface->Move(RI_HEAD_DOWN, 1);
-    sleep(2);
+    moveHead(RI_HEAD_DOWN);
+    _camera->logCenterStats();
 
     _centerTurnPID->flushPID();
     _centerStrafePID->flushPID();
@@ -747,9 +1073,14 @@ void Robot::center() {
  *             using a kalman filter
  **************************************/
 void Robot::updatePose(bool useWheelEncoders) {
-    // update the robot interface so wheel encoder
+    // take the latest sensor snapshot so wheel encoder
     // and north star have the same time-values
-    _updateInterface();
+    _sensorThread->getSnapshot(&_snapshot);
+    if (_snapshot.failures >= getFailLimit()) {
+        LOG.write(LOG_HIGH, "sensor_thread", 
+                  "%d interface updates failed in a row, data is %f s old",
+                  _snapshot.failures, Util::getTime() - _snapshot.time);
+    }
     // update each pose estimate
     _northStar->updatePose();
     if(useWheelEncoders) {
@@ -803,13 +1134,62 @@ void Robot::updatePose(bool useWheelEncoders) {
     _kalmanFilter->filter(_northStar->getPose(), 
                           _wheelEncoders->getPose());
 
-    LOG.write(LOG_LOW, "position_data", "Room:\t%d\tNS:\t%f\t%f\t%f\tWE:\t%f\t%f\t%f\tKalman:\t%f\t%f\t%f\t", getRoom(), _northStar->getX(), _northStar->getY(), _northStar->getTheta(), _wheelEncoders->getX(), _wheelEncoders->getY(), _wheelEncoders->getTheta(), _pose->getX(), _pose->getY(), _pose->getTheta());
+    LOG.write(LOG_LOW, "position_data", "Room:\t%d\tNS:\t%f\t%f\t%f\tWE:\t%f\t%f\t%f\tKalman:\t%f\t%f\t%f\t", getRoom(), _northStar->getX(), _northStar->getY(), _northStar->getTheta(), _wheelEncoders->getX(), _wheelEncoders->getY(), _wheelEncoders->getTheta(), _pose.getX(), _pose.getY(), _pose.getTheta());
+
+    // keep the filtered pose so the run can be looked at afterwards
+    _trajectory.append(&_pose, Util::getTime());
 }
 
 RobotInterface* Robot::getInterface() {
     return _robotInterface;
 }
 
+/**************************************
+ * Definition: Returns the sensor snapshot the pose was last
+ *             updated from
+ *
+ * Returns:    a pointer to the snapshot
+ **************************************/
+SensorSnapshot* Robot::getSnapshot() {
+    return &_snapshot;
+}
+
+/**************************************
+ * Definition: Returns how good the link to the robot is lately
+ *
+ * Returns:    a quality from 0 (nothing getting through) to 1
+ **************************************/
+float Robot::getLinkQuality() {
+    return _snapshot.linkQuality;
+}
+
+/**************************************
+ * Definition: Slows a speed down to what the link can keep up with,
+ *             so we don't drive fast on old sensor data
+ *
+ * Parameters: the speed we'd like to go
+ *
+ * Returns:    the speed to go, or 0 to stop until the data is fresh
+ **************************************/
+int Robot::_linkSpeed(int speed) {
+    if (speed == 0) {
+        return 0;
+    }
+    double age = Util::getTime() - _snapshot.time;
+    if (age > LINK_STALE_TIME) {
+        LOG.write(LOG_MED, "link_health", 
+                  "sensor data is %f s old, stopping", age);
+        return 0;
+    }
+    if (_snapshot.linkQuality < LINK_POOR_QUALITY && speed < LINK_POOR_SPEED) {
+        LOG.write(LOG_LOW, "link_health", 
+                  "link quality %f, slowing from speed %d to %d",
+                  _snapshot.linkQuality, speed, LINK_POOR_SPEED);
+        return LINK_POOR_SPEED;
+    }
+    return speed;
+}
+
 /************************************
  * Definition:	Returns the name of the robot being used
  ***********************************/
@@ -823,7 +1203,16 @@ int Robot::getName() {
  * Returns:    a pointer to a pose
  **************************************/
 Pose* Robot::getPose() {
-    return _pose;
+    return &_pose;
+}
+
+/**************************************
+ * Definition: Returns every filtered pose since the robot started
+ *
+ * Returns:    a pointer to the robot's trajectory
+ **************************************/
+Trajectory* Robot::getTrajectory() {
+    return &_trajectory;
 }
 
 /**************************************
@@ -832,6 +1221,7 @@ Pose* Robot::getPose() {
 void Robot::prefillData() {
     printf("prefilling data...\n");
     for (int i = 0; i < MAX_FILTER_TAPS; i++){
+        _sensorThread->waitForUpdate();
         updatePose(true);
     }
     printf("sufficient data collected\n");
@@ -846,11 +1236,13 @@ void Robot::prefillData() {
 void Robot::moveForward(int speed) {
 	_movingForward = true;
     _speed = speed;
-    _robotInterface->Move(RI_MOVE_FORWARD, speed);
+    _drive(RI_MOVE_FORWARD, speed);
 }
 
 /**************************************
- * Definition: Turns the robot left at the given speed.
+ * Definition: Starts turning the robot left at the given speed 
+ *             and returns right away. The robot keeps turning
+ *             until another command (or stop) is sent.
  *             (Wrapper around robot interface)
  *
  * Parameters: int specifying speed to turn at
@@ -859,19 +1251,13 @@ void Robot::turnLeft(int speed) {
 	_turnDirection = DIR_LEFT;
 	_movingForward = false;
 	_speed = speed;
-    int sleepLength = 300000; 
-    if(speed > 6) { 
-       _robotInterface->Move(RI_TURN_LEFT, 6);
-       sleepLength -= 50000*(speed-6);
-    } else {
-       _robotInterface->Move(RI_TURN_LEFT, speed);
-    }
-    usleep(sleepLength);
-    _robotInterface->Move(RI_STOP, 0);
+    _drive(RI_TURN_LEFT, speed > SLOWEST_TURN_SPEED ? SLOWEST_TURN_SPEED : speed);
 }
 
 /**************************************
- * Definition: Turns the robot right at the given speed.
+ * Definition: Starts turning the robot right at the given speed 
+ *             and returns right away. The robot keeps turning
+ *             until another command (or stop) is sent.
  *             (Wrapper around robot interface)
  *
  * Parameters: int specifying speed to turn at
@@ -880,53 +1266,39 @@ void Robot::turnRight(int speed) {
 	_turnDirection = DIR_RIGHT;
 	_movingForward = false;
 	_speed = speed;
-    int sleepLength = 300000; 
-    if(speed > 6) { 
-       _robotInterface->Move(RI_TURN_RIGHT, 6);
-       sleepLength -= 50000*(speed-6);
-    } else {
-       _robotInterface->Move(RI_TURN_RIGHT, speed);
-    }
-    usleep(sleepLength);
-    _robotInterface->Move(RI_STOP, 0);
+    _drive(RI_TURN_RIGHT, speed > SLOWEST_TURN_SPEED ? SLOWEST_TURN_SPEED : speed);
 }
 
 /**************************************
- * Definition: Strafes the robot left at the given speed.
- *             (Wrapper around robot interface)
+ * Definition: Starts strafing the robot left and returns
+ *             right away. (Wrapper around robot interface)
  *
  * Note:       Since strafing sideways is difficult, the
- *             command is sent multiple times to scale with
- *             the speed in order to avoid turning the robot.
+ *             command is always sent at speed 10 to avoid turning
+ *             the robot; callers scale how long they strafe for
+ *             with the speed instead.
  *
  * Parameters: int specifying speed to strafe at
  **************************************/
 void Robot::strafeLeft(int speed) {
     _speed = speed;
-    int sleepLength = 500000-(45000*speed);
-
-    _robotInterface->Move(RI_MOVE_LEFT, 10);
-    usleep(sleepLength);
-    _robotInterface->Move(RI_STOP, 0);
+    _drive(RI_MOVE_LEFT, 10);
 }
 
 /**************************************
- * Definition: Strafes the robot right at the given speed.
- *             (Wrapper around robot interface)
+ * Definition: Starts strafing the robot right and returns
+ *             right away. (Wrapper around robot interface)
  *
  * Note:       Since strafing sideways is difficult, the
- *             command is sent multiple times to scale with
- *             the speed in order to avoid turning the robot.
+ *             command is always sent at speed 10 to avoid turning
+ *             the robot; callers scale how long they strafe for
+ *             with the speed instead.
  *
  * Parameters: int specifying speed to strafe at
  **************************************/
 void Robot::strafeRight(int speed) {
     _speed = speed;
-    int sleepLength = 500000-(45000*speed);
-
-    _robotInterface->Move(RI_MOVE_RIGHT, 10);
-    usleep(sleepLength);
-    _robotInterface->Move(RI_STOP, 0);
+    _drive(RI_MOVE_RIGHT, 10);
 }
 
 /**************************************
@@ -936,7 +1308,40 @@ void Robot::strafeRight(int speed) {
 void Robot::stop() {
 	_movingForward = true;
 	_speed = 0;
-    _robotInterface->Move(RI_STOP, 0);
+    _drive(RI_STOP, 0);
+}
+
+/**************************************
+ * Definition: Sends a movement command to the robot and remembers
+ *             it, so it can be repeated while we wait on it
+ *
+ * Parameters: ints specifying the robot interface command and speed
+ **************************************/
+void Robot::_drive(int command, int speed) {
+    _command = command;
+    _commandSpeed = speed;
+    InterfaceLock lock;
+    _robotInterface->Move(command, speed);
+}
+
+/**************************************
+ * Definition: Keeps the current movement command going for the
+ *             given time, ticking the control loop so the pose
+ *             stays up to date while we move
+ *
+ * Parameters: double specifying seconds, and bool specifying 
+ *             whether to use the wheel encoders in the pose
+ **************************************/
+void Robot::_runFor(double seconds, bool useWheelEncoders) {
+    _controlLoop->start();
+    double end = _controlLoop->getTickTime() + seconds;
+    while (_controlLoop->getTickTime() < end) {
+        updatePose(useWheelEncoders);
+        if (_command != RI_STOP) {
+            _drive(_command, _commandSpeed);
+        }
+        _controlLoop->waitForTick();
+    }
 }
 
 /**************************************
@@ -945,7 +1350,7 @@ void Robot::stop() {
  * Returns:    int specifying the room (starting at 0)
  **************************************/
 int Robot::getRoom() {
-    return _robotInterface->RoomID() - 2;
+    return _snapshot.room - 2;
 }
 
 /**************************************
@@ -955,7 +1360,7 @@ int Robot::getRoom() {
  * Returns:    int specifying battery level
  **************************************/
 int Robot::getBattery() {
-    return _robotInterface->Battery();
+    return _snapshot.battery;
 }
 
 /**************************************
@@ -965,7 +1370,7 @@ int Robot::getBattery() {
  * Returns:    int specifying battery level
  **************************************/
 int Robot::getStrength(){
-    return _robotInterface->NavStrengthRaw();
+    return _snapshot.strength;
 }
 
 /**************************************
@@ -975,33 +1380,13 @@ int Robot::getStrength(){
  * Returns:    bool specifying if the robot is blocked or not
  **************************************/
 bool Robot::isThereABitchInMyWay() {
-    return _robotInterface->IR_Detected();
-}
-
-/**************************************
- * Definition: Attempts to update the robot interface a certain
- *             amount of times. Returns true on success.
- *
- * Returns:    bool specifying if we succeeded
- **************************************/
-bool Robot::_updateInterface() {
-    int failCount = 0;
-    int failLimit = getFailLimit();
-
-    while (_robotInterface->update() != RI_RESP_SUCCESS &&
-           failCount < failLimit) {
-        failCount++;
-    }
-
-    if (failCount >= failLimit) {
-        return false;
-    }
-    return true;
+    return _snapshot.irDetected;
 }
 
 /**************************************
- * Definition: Sets the amount of times we can fail at
- *             updating the robot interface before stopping.
+ * Definition: Sets the amount of times in a row updating the
+ *             robot interface can fail before we complain that
+ *             the sensor data is stale.
  *
  * Parameters: int specifying the limit
  **************************************/
@@ -1058,9 +1443,15 @@ void Robot::printFailPhrase() {
  **************************************/
 void Robot::rockOut() {
     for (int i = 0; i < 1; i++) {
-        _robotInterface->Move(RI_HEAD_UP, 1);
+        {
+            InterfaceLock lock;
+            _robotInterface->Move(RI_HEAD_UP, 1);
+        }
         sleep(1);
-        _robotInterface->Move(RI_HEAD_DOWN, 1);
+        {
+            InterfaceLock lock;
+            _robotInterface->Move(RI_HEAD_DOWN, 1);
+        }
         sleep(1);
     }
 }
@@ -19,12 +19,18 @@
 #include "map.h"
 #include "map_strategy.h"
 #include "pose.h"
+#include "trajectory.h"
+#include "rate_scheduler.h"
+#include "motion_queue.h"
+#include "motion_profile.h"
+#include "sensor_thread.h"
 #include "camera.h"
 #include "wheel_encoders.h"
 #include "north_star.h"
 #include "fir_filter.h"
 #include "kalman_filter.h"
 #include "PID.h"
+#include "pid_gains.h"
 #include "utilities.h"
 #include "constants.h"
 
@@ -35,6 +41,8 @@
 #include <robot_if++.h>
 #include <string>
 
+class StopModel; // so we can avoid circular dependency
+
 #define GOOD_NS_STRENGTH 13222
 
 #define MAX_CAMERA_BRIGHTNESS (0x7F)
@@ -42,11 +50,31 @@
 
 #define NUM_SPEEDS 11
 
+// the robot doesn't turn reliably at speed levels slower than this
+#define SLOWEST_TURN_SPEED 6
+
 #define DIR_LEFT 0
 #define DIR_RIGHT 1
 
 #define CELL_SIZE 65
 
+// speed to drive from cell to cell at, and how far from the end of
+// a cell to plan (and queue up) the next one
+#define CELL_SPEED 2
+#define CELL_BLEND_DISTANCE 15.0 // cm
+
+// how long to take picking the next cell while the move into this one
+// is still going, since nothing services it meanwhile. The planner has
+// usually picked it already (see Planner).
+#define NEXT_CELL_MOVING_BUDGET (1.0 / CONTROL_RATE) // seconds
+
+// when the link to the robot is poor, drive no faster than
+// LINK_POOR_SPEED, and stop altogether once the sensor data
+// is older than LINK_STALE_TIME
+#define LINK_POOR_QUALITY 0.5
+#define LINK_POOR_SPEED 6
+#define LINK_STALE_TIME 0.5 // seconds
+
 const float TIME_DISTANCE = 116.0; // cm
 
 // average speed to move forward TIME_DISTANCE at integer robot speeds
@@ -103,6 +131,12 @@ public:
     ~Robot();
     void eatShit();
     void move(int direction, int numCells);
+    MotionHandle moveAsync(int direction, int numCells);
+    MotionHandle submitMotion(MotionSegment *segment);
+    bool motionDone(MotionHandle handle);
+    void waitForMotion(MotionHandle handle);
+    void serviceMotion();
+    void cancelMotion();
     void turn(int direction);
     void turn(int relDirection, float radians);
     void moveToCell(float x, float y);
@@ -124,7 +158,10 @@ public:
     void stop();
 	void moveHead(int position);
     Pose* getPose();
+    Trajectory* getTrajectory();
     RobotInterface* getInterface();
+    SensorSnapshot* getSnapshot();
+    float getLinkQuality();
     int getName();
     bool isThereABitchInMyWay();
 	int getStrength();
@@ -138,25 +175,38 @@ public:
 
     Camera *_camera;
 private:
-    bool _centerTurn(float centerError);
-    bool _centerStrafe(float centerError);
+    bool _centerTurn(float centerError, MotionSegment *turn);
+    bool _centerStrafe(float centerError, MotionSegment *strafe);
+    void _centerBoth(MotionSegment *turn, MotionSegment *strafe);
+    void _drive(int command, int speed);
+    void _send(int command, int speed);
+    int _linkSpeed(int speed);
+    void _runFor(double seconds, bool useWheelEncoders);
+    int _directionTo(Cell *cell);
+    float _thetaFor(int direction);
     
     RobotInterface *_robotInterface;
+    SensorThread *_sensorThread;
+    SensorSnapshot _snapshot;
     int _name;
 
 	int _speed;	
 	char _turnDirection;
 	bool _movingForward;
     int _heading;
+    int _command;
+    int _commandSpeed;
 
     PID* _movePID;
     PID* _turnPID;
     PID* _centerTurnPID;
     PID* _centerStrafePID;
+    StopModel *_stopModel;
 
     int _failLimit;
 
-    Pose *_pose;
+    Pose _pose;
+    Trajectory _trajectory;
 
     //Camera *_camera;
     WheelEncoders *_wheelEncoders;
@@ -164,10 +214,14 @@ private:
 
     KalmanFilter *_kalmanFilter;
 
+    RateScheduler *_controlLoop;
+    MotionQueue *_motionQueue;
+    MotionProfile *_moveProfile;
+    MotionProfile *_turnProfile;
+
     Map *_map;
     MapStrategy *_mapStrategy;
     
-    bool _updateInterface();
 };
 
 #endif
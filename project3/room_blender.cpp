@@ -0,0 +1,139 @@
+/**
+ * room_blender.cpp
+ *
+ * @brief
+ *      This class keeps a global pose estimate for every north star room
+ *      that has been seen recently and blends them, weighted by signal
+ *      strength and age, so that the pose doesn't jump when the robot
+ *      crosses from one room's beacon into another's.
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#include "room_blender.h"
+#include "utilities.h"
+#include "logger.h"
+
+RoomBlender::RoomBlender(Calibration *calibration) {
+    _calibration = calibration;
+    _window = NS_BLEND_WINDOW;
+    reset();
+}
+
+RoomBlender::~RoomBlender() {}
+
+/**************************************
+ * Definition: Forgets every room's estimate
+ **************************************/
+void RoomBlender::reset() {
+    for (int i = 0; i < NUM_ROOMS; i++) {
+        _rooms[i].x = 0.0;
+        _rooms[i].y = 0.0;
+        _rooms[i].theta = 0.0;
+        _rooms[i].strength = 0.0;
+        _rooms[i].age = 0;
+        _rooms[i].seen = false;
+    }
+    _lastRoom = -1;
+}
+
+/**************************************
+ * Definition: Sets how many updates a room is blended in for
+ *             after its beacon was last seen
+ *
+ * Parameters: int specifying the number of updates
+ **************************************/
+void RoomBlender::setWindow(int window) {
+    _window = window;
+}
+
+/**************************************
+ * Definition: Stores a new raw north star reading for the given room
+ *             and blends every recently seen room into a global pose.
+ *
+ *             Rooms that weren't seen this update are carried along
+ *             with the motion of the current room, so an old estimate
+ *             only contributes its offset (which fades out over the
+ *             window) rather than an old position.
+ *
+ * Parameters: the room the reading is from, raw x, y and theta,
+ *             the signal strength and a pose to store the result in
+ **************************************/
+void RoomBlender::update(int room, float x, float y, float theta,
+                         int strength, Pose *result) {
+    Pose estimate(x, y, theta);
+    _calibration->toGlobal(room, &estimate);
+
+    RoomEstimate *current = &_rooms[room];
+
+    // move the other rooms' estimates along with this room
+    if (current->seen && _lastRoom == room) {
+        float deltaX = estimate.getX() - current->x;
+        float deltaY = estimate.getY() - current->y;
+        float deltaTheta = Util::normalizeThetaError(estimate.getTheta() -
+                                                     current->theta);
+        for (int i = 0; i < NUM_ROOMS; i++) {
+            if (i != room && _rooms[i].seen) {
+                _rooms[i].x += deltaX;
+                _rooms[i].y += deltaY;
+                _rooms[i].theta = Util::normalizeTheta(_rooms[i].theta +
+                                                       deltaTheta);
+            }
+        }
+    }
+
+    for (int i = 0; i < NUM_ROOMS; i++) {
+        _rooms[i].age++;
+    }
+    current->x = estimate.getX();
+    current->y = estimate.getY();
+    current->theta = estimate.getTheta();
+    current->strength = strength;
+    current->age = 0;
+    current->seen = true;
+    _lastRoom = room;
+
+    float sumWeight = 0.0;
+    float sumX = 0.0;
+    float sumY = 0.0;
+    float sumSin = 0.0;
+    float sumCos = 0.0;
+    for (int i = 0; i < NUM_ROOMS; i++) {
+        RoomEstimate *r = &_rooms[i];
+        if (!r->seen || r->age > _window) {
+            continue;
+        }
+        // stronger and more recent beacons count for more
+        float weight = r->strength * (1.0 - (float)r->age / (_window + 1));
+        sumWeight += weight;
+        sumX += weight * r->x;
+        sumY += weight * r->y;
+        sumSin += weight * sin(r->theta);
+        sumCos += weight * cos(r->theta);
+    }
+
+    if (sumWeight <= 0.0) {
+        result->reset(current->x, current->y, current->theta);
+        return;
+    }
+
+    result->reset(sumX / sumWeight, sumY / sumWeight, atan2(sumSin, sumCos));
+
+    LOG.write(LOG_LOW, "NS_room_blend",
+              "room %d: (%f, %f, %f) blended: (%f, %f, %f)",
+              room+2, current->x, current->y, current->theta,
+              result->getX(), result->getY(), result->getTheta());
+}
+
+/**************************************
+ * Definition: Returns the stored estimate for a room
+ *
+ * Parameters: int specifying the room (starting at 0)
+ **************************************/
+RoomEstimate* RoomBlender::getEstimate(int room) {
+    return &_rooms[room];
+}
@@ -0,0 +1,50 @@
+/**
+ * room_blender.h
+ *
+ * @brief
+ *      This class keeps a global pose estimate for every north star room
+ *      that has been seen recently and blends them, weighted by signal
+ *      strength and age, so that the pose doesn't jump when the robot
+ *      crosses from one room's beacon into another's.
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#ifndef CS1567_ROOMBLENDER_H
+#define CS1567_ROOMBLENDER_H
+
+#include "calibration.h"
+#include "pose.h"
+
+// how many updates a room's estimate is blended in after its
+// beacon was last seen
+#define NS_BLEND_WINDOW 10
+
+typedef struct {
+    float x, y, theta;  // global estimate from this room's beacon
+    float strength;     // signal strength when last seen
+    int age;            // updates since this room was last seen
+    bool seen;
+} RoomEstimate;
+
+class RoomBlender {
+public:
+    RoomBlender(Calibration *calibration);
+    ~RoomBlender();
+    void reset();
+    void setWindow(int window);
+    void update(int room, float x, float y, float theta,
+                int strength, Pose *result);
+    RoomEstimate* getEstimate(int room);
+private:
+    Calibration *_calibration;
+    RoomEstimate _rooms[NUM_ROOMS];
+    int _window;
+    int _lastRoom;
+};
+
+#endif
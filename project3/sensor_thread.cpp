@@ -0,0 +1,185 @@
+/**
+ * sensor_thread.cpp
+ * 
+ * @brief 
+ *      This class runs the robot interface updates on their own thread,
+ *      at their own rate, and publishes each update as a timestamped
+ *      snapshot. Readers copy the latest snapshot through a seqlock, so
+ *      they never wait on the network (or on the writer) and always see
+ *      a snapshot from a single update.
+ *
+ *      The robot interface isn't safe to call from two threads at once,
+ *      so every call into it goes through an InterfaceLock.
+ *
+ *      Failed updates are retried with a jittered exponential backoff
+ *      (see LinkHealth), and the link's quality is published with
+ *      every snapshot.
+ * 
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#include "sensor_thread.h"
+#include "rate_scheduler.h"
+#include "utilities.h"
+#include "logger.h"
+#include <string.h>
+#include <unistd.h>
+
+pthread_mutex_t InterfaceLock::_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+SensorThread::SensorThread(RobotInterface *robotInterface) {
+    _robotInterface = robotInterface;
+    _running = false;
+    _writeCount = 0;
+    memset(&_snapshot, 0, sizeof(SensorSnapshot));
+}
+
+SensorThread::~SensorThread() {
+    stop();
+}
+
+/**************************************
+ * Definition: Starts polling the robot interface
+ *
+ * Returns:    false if the thread couldn't be created
+ **************************************/
+bool SensorThread::start() {
+    if (_running) {
+        return true;
+    }
+    _running = true;
+    if (pthread_create(&_thread, NULL, _run, this) != 0) {
+        LOG.write(LOG_HIGH, "sensor_thread", "unable to start sensor thread");
+        _running = false;
+        return false;
+    }
+    return true;
+}
+
+/**************************************
+ * Definition: Stops polling and waits for the thread to finish
+ **************************************/
+void SensorThread::stop() {
+    if (!_running) {
+        return;
+    }
+    _running = false;
+    pthread_join(_thread, NULL);
+}
+
+/**************************************
+ * Definition: Copies out the latest snapshot. Never blocks: if the
+ *             snapshot changes while it's being copied, the copy is
+ *             simply taken again.
+ *
+ * Parameters: pointer to store the snapshot in
+ **************************************/
+void SensorThread::getSnapshot(SensorSnapshot *snapshot) {
+    unsigned int before;
+    unsigned int after;
+    do {
+        before = _writeCount;
+        __sync_synchronize();
+        *snapshot = _snapshot;
+        __sync_synchronize();
+        after = _writeCount;
+    } while (before != after || (before & 1));
+}
+
+/**************************************
+ * Definition: Returns the number of successful updates so far
+ **************************************/
+unsigned int SensorThread::getSequence() {
+    SensorSnapshot snapshot;
+    getSnapshot(&snapshot);
+    return snapshot.sequence;
+}
+
+/**************************************
+ * Definition: Waits until a snapshot newer than the current one
+ *             has been published
+ **************************************/
+void SensorThread::waitForUpdate() {
+    unsigned int sequence = getSequence();
+    while (_running && getSequence() == sequence) {
+        usleep(1000);
+    }
+}
+
+void* SensorThread::_run(void *sensorThread) {
+    ((SensorThread *)sensorThread)->_loop();
+    return NULL;
+}
+
+/**************************************
+ * Definition: Polls the robot interface at SENSOR_RATE and 
+ *             publishes a snapshot after every successful update
+ **************************************/
+void SensorThread::_loop() {
+    RateScheduler scheduler(SENSOR_RATE);
+    SensorSnapshot snapshot;
+    memset(&snapshot, 0, sizeof(SensorSnapshot));
+
+    _health.reset();
+    while (_running) {
+        bool success;
+        double latency;
+        {
+            InterfaceLock lock;
+            double start = Util::getTime();
+            success = _robotInterface->update() == RI_RESP_SUCCESS;
+            latency = Util::getTime() - start;
+            if (success) {
+                snapshot.x = _robotInterface->X();
+                snapshot.y = _robotInterface->Y();
+                snapshot.theta = _robotInterface->Theta();
+                snapshot.room = _robotInterface->RoomID();
+                snapshot.strength = _robotInterface->NavStrengthRaw();
+                snapshot.left += _robotInterface->getWheelEncoder(RI_WHEEL_LEFT);
+                snapshot.right += _robotInterface->getWheelEncoder(RI_WHEEL_RIGHT);
+                snapshot.rear += _robotInterface->getWheelEncoder(RI_WHEEL_REAR);
+                snapshot.irDetected = _robotInterface->IR_Detected();
+                snapshot.battery = _robotInterface->Battery();
+            }
+        }
+
+        _health.record(latency, success);
+        snapshot.linkQuality = _health.getQuality();
+
+        if (success) {
+            snapshot.sequence++;
+            snapshot.time = Util::getTime();
+            snapshot.failures = 0;
+            snapshot.latency = latency;
+            _publish(&snapshot);
+            scheduler.waitForTick();
+        }
+        else {
+            // let readers see that the data is going stale, and
+            // give the link a chance to recover before trying again
+            snapshot.failures++;
+            _publish(&snapshot);
+            double backoff = _health.getBackoff();
+            LOG.write(LOG_MED, "sensor_thread", 
+                      "interface update failed (%d in a row), "
+                      "retrying in %f s", snapshot.failures, backoff);
+            usleep(backoff * 1000000);
+        }
+    }
+
+    scheduler.logStats("sensor_thread");
+    _health.logStats("sensor_thread");
+}
+
+/**************************************
+ * Definition: Publishes a snapshot to readers
+ **************************************/
+void SensorThread::_publish(SensorSnapshot *snapshot) {
+    __sync_fetch_and_add(&_writeCount, 1);
+    _snapshot = *snapshot;
+    __sync_fetch_and_add(&_writeCount, 1);
+}
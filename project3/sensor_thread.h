@@ -0,0 +1,92 @@
+/**
+ * sensor_thread.h
+ * 
+ * @brief 
+ *      This class runs the robot interface updates on their own thread,
+ *      at their own rate, and publishes each update as a timestamped
+ *      snapshot. Readers copy the latest snapshot through a seqlock, so
+ *      they never wait on the network (or on the writer) and always see
+ *      a snapshot from a single update.
+ *
+ *      The robot interface isn't safe to call from two threads at once,
+ *      so every call into it goes through an InterfaceLock.
+ *
+ *      Failed updates are retried with a jittered exponential backoff
+ *      (see LinkHealth), and the link's quality is published with
+ *      every snapshot.
+ * 
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#ifndef CS1567_SENSORTHREAD_H
+#define CS1567_SENSORTHREAD_H
+
+#include "link_health.h"
+
+#include <robot_if++.h>
+#include <pthread.h>
+
+#define SENSOR_RATE 30 // Hz
+
+typedef struct {
+    unsigned int sequence;   // number of successful updates so far
+    double time;             // when the update finished (Util::getTime)
+    int failures;            // failed updates since the last success
+    float linkQuality;       // see LinkHealth::getQuality
+    double latency;          // seconds the last successful update took
+
+    // north star
+    int x, y;
+    float theta;
+    int room;                // RoomID (starting at 2)
+    int strength;
+
+    // wheel encoder ticks summed over every update, so readers
+    // that skip updates don't lose ticks
+    long left, right, rear;
+
+    bool irDetected;
+    int battery;
+} SensorSnapshot;
+
+class InterfaceLock {
+public:
+    InterfaceLock() {
+        pthread_mutex_lock(&_mutex);
+    }
+    ~InterfaceLock() {
+        pthread_mutex_unlock(&_mutex);
+    }
+private:
+    static pthread_mutex_t _mutex;
+};
+
+class SensorThread {
+public:
+    SensorThread(RobotInterface *robotInterface);
+    ~SensorThread();
+    bool start();
+    void stop();
+    void getSnapshot(SensorSnapshot *snapshot);
+    unsigned int getSequence();
+    void waitForUpdate();
+private:
+    RobotInterface *_robotInterface;
+    pthread_t _thread;
+    volatile bool _running;
+
+    // odd while a snapshot is being written
+    volatile unsigned int _writeCount;
+    SensorSnapshot _snapshot;
+    LinkHealth _health;
+
+    static void* _run(void *sensorThread);
+    void _loop();
+    void _publish(SensorSnapshot *snapshot);
+};
+
+#endif
@@ -0,0 +1,154 @@
+/**
+ * stop_model.cpp
+ *
+ * @brief
+ *      This class predicts how far the robot keeps going after it's
+ *      told to stop, at each forward speed, so moves can stop early
+ *      enough to coast onto their goal. The distances are fitted per
+ *      robot from recorded drive logs by data/fit_stop.cpp and loaded
+ *      from a stop file, falling back to STOP_DEFAULT_TIME at each
+ *      level's speed.
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#include "stop_model.h"
+#include "calibration.h"
+#include "utilities.h"
+#include "logger.h"
+
+#include <stdio.h>
+
+StopModel::StopModel() {
+    for (int i = 0; i < NUM_SPEEDS; i++) {
+        _distances[i] = SPEED_FORWARD[i] * STOP_DEFAULT_TIME;
+        _settleTimes[i] = i == 0 ? 0.0 : STOP_DEFAULT_SETTLE;
+    }
+}
+
+StopModel::~StopModel() {}
+
+/**************************************
+ * Definition: Reads a stop file. Each non-comment line holds
+ *             one speed level:
+ *
+ *             level distance settle_time
+ *
+ *             Levels that aren't in the file keep their
+ *             current values.
+ *
+ * Parameters: the file to read
+ *
+ * Returns:    true if at least one level was read
+ **************************************/
+bool StopModel::load(std::string fileName) {
+    FILE *file = fopen(fileName.c_str(), "r");
+    if (file == NULL) {
+        LOG.write(LOG_MED, "stop_model",
+                  "No stop file %s, using default stop distances", 
+                  fileName.c_str());
+        return false;
+    }
+
+    bool found = false;
+    char line[256];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        char *start = line;
+        while (*start == ' ' || *start == '\t') {
+            start++;
+        }
+        if (*start == '#' || *start == '\0' || 
+            *start == '\n' || *start == '\r') {
+            continue;
+        }
+
+        int level;
+        float distance;
+        float settleTime;
+        int numRead = sscanf(start, "%d %f %f", &level, &distance, &settleTime);
+        if (numRead != 3 || level < 1 || level >= NUM_SPEEDS || 
+            distance < 0 || settleTime < 0) {
+            LOG.write(LOG_HIGH, "stop_model",
+                      "Skipping bad stop line: %s", start);
+            continue;
+        }
+
+        set(level, distance, settleTime);
+        found = true;
+    }
+    fclose(file);
+
+    LOG.write(LOG_MED, "stop_model", "Loaded stop file %s", fileName.c_str());
+    return found;
+}
+
+/**************************************
+ * Definition: Returns how far the robot goes after a stop
+ *
+ * Parameters: the speed level it's going at
+ *
+ * Returns:    the distance in cm (0 if it's already stopped)
+ **************************************/
+float StopModel::getStopDistance(int level) {
+    if (level <= 0 || level >= NUM_SPEEDS) {
+        return 0.0;
+    }
+    return _distances[level];
+}
+
+/**************************************
+ * Definition: Returns how long the robot takes to come to rest
+ *             after a stop
+ *
+ * Parameters: the speed level it's going at
+ **************************************/
+float StopModel::getSettleTime(int level) {
+    if (level <= 0 || level >= NUM_SPEEDS) {
+        return 0.0;
+    }
+    return _settleTimes[level];
+}
+
+/**************************************
+ * Definition: Sets the stop distance and settling time for a level
+ **************************************/
+void StopModel::set(int level, float distance, float settleTime) {
+    _distances[level] = distance;
+    _settleTimes[level] = settleTime;
+}
+
+/**************************************
+ * Definition: Writes every level in the format read by load()
+ *
+ * Parameters: the file to write and the robot's name
+ *
+ * Returns:    true on success
+ **************************************/
+bool StopModel::write(std::string fileName, std::string robotName) {
+    FILE *file = fopen(fileName.c_str(), "w");
+    if (file == NULL) {
+        return false;
+    }
+
+    fprintf(file, "# stop distances for %s\n", robotName.c_str());
+    fprintf(file, "# level\tdistance (cm)\tsettle time (s)\n");
+    for (int i = 1; i < NUM_SPEEDS; i++) {
+        fprintf(file, "%d\t%.1f\t%.2f\n", i, _distances[i], _settleTimes[i]);
+    }
+
+    fclose(file);
+    return true;
+}
+
+/**************************************
+ * Definition: Returns the default stop file path for a robot
+ *
+ * Parameters: int specifying the robot's name
+ **************************************/
+std::string StopModel::fileNameFor(int name) {
+    return std::string(CALIBRATION_DIR) + ROBOTS[name] + STOP_MODEL_EXT;
+}
@@ -0,0 +1,49 @@
+/**
+ * stop_model.h
+ *
+ * @brief
+ *      This class predicts how far the robot keeps going after it's
+ *      told to stop, at each forward speed, so moves can stop early
+ *      enough to coast onto their goal. The distances are fitted per
+ *      robot from recorded drive logs by data/fit_stop.cpp and loaded
+ *      from a stop file, falling back to STOP_DEFAULT_TIME at each
+ *      level's speed.
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#ifndef CS1567_STOPMODEL_H
+#define CS1567_STOPMODEL_H
+
+#include "robot.h"
+
+#include <string>
+
+#define STOP_MODEL_EXT ".stop"
+
+// how long the robot keeps going at speed after a stop, and how
+// long it takes to come to rest, if there's no stop file
+#define STOP_DEFAULT_TIME 0.3 // seconds
+#define STOP_DEFAULT_SETTLE 0.6 // seconds
+
+class StopModel {
+public:
+    StopModel();
+    ~StopModel();
+    bool load(std::string fileName);
+    float getStopDistance(int level);
+    float getSettleTime(int level);
+    void set(int level, float distance, float settleTime);
+    bool write(std::string fileName, std::string robotName);
+
+    static std::string fileNameFor(int name);
+private:
+    float _distances[NUM_SPEEDS];   // cm
+    float _settleTimes[NUM_SPEEDS]; // seconds
+};
+
+#endif
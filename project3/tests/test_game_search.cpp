@@ -0,0 +1,293 @@
+// Checks the game search (see GameSearch) against plain minimax on
+// generated boards. Each board is searched from a few positions in a
+// row, like a game, with the transposition table carried from one
+// search to the next. The boards are crowded with posts, so searches
+// see the end of the game, and every search must find the same value
+// as minimax does searching to the end. (Short of the end, stored
+// results from deeper searches rightly change the value, so it can't
+// be compared to minimax at a fixed depth.) Also checks that it gives
+// up when no pellet can be reached.
+//
+// usage: test_game_search.out [boards]
+//
+// Exits non-zero if any search disagrees with minimax.
+#include "../game_search.h"
+#include "../path.h"
+#include "../logger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define DEFAULT_BOARDS 10
+#define MOVES_PER_BOARD 4
+#define SEARCHES_PER_MOVE 2
+#define SEARCH_BUDGET 0.1 // seconds
+
+// one cell in this many is a post, so there's little enough room left
+// for minimax to search to the end of the game
+#define POST_ODDS 4
+
+#define VALUE_TOLERANCE 0.001
+#define MINIMAX_INFINITY 1000000.0
+
+// a board with posts on about every POST_ODDS cell and a pellet on
+// most of the rest, with us in one corner and the opponent in the other
+map_obj_t* generateMap(unsigned int seed) {
+	map_obj_t *head = NULL;
+	for (int x = 0; x < MAP_WIDTH; x++) {
+		for (int y = 0; y < MAP_HEIGHT; y++) {
+			map_obj_t *obj = new map_obj_t;
+			obj->x = x;
+			obj->y = y;
+			obj->points = 0;
+			obj->next = head;
+			head = obj;
+
+			int roll = rand_r(&seed) % (POST_ODDS * 10);
+			if (x == 0 && y == 0) {
+				obj->type = MAP_OBJ_ROBOT_1;
+			}
+			else if (x == MAP_WIDTH-1 && y == MAP_HEIGHT-1) {
+				obj->type = MAP_OBJ_ROBOT_2;
+			}
+			else if (roll < 10) {
+				obj->type = MAP_OBJ_POST;
+			}
+			else if (roll < 12) {
+				obj->type = MAP_OBJ_EMPTY;
+			}
+			else {
+				obj->type = MAP_OBJ_PELLET;
+				obj->points = 1 + rand_r(&seed) % 5;
+			}
+		}
+	}
+	return head;
+}
+
+void freeMap(map_obj_t *map) {
+	while (map != NULL) {
+		map_obj_t *next = map->next;
+		delete map;
+		map = next;
+	}
+}
+
+float ourValues[BOARD_CELLS];
+float theirValues[BOARD_CELLS];
+
+// the cells a robot can move to, and the headings it moves in
+int moves(int index, uint64_t blocked, int *targets, int *headings) {
+	int x = index % MAP_WIDTH;
+	int y = index / MAP_WIDTH;
+	int nextX[4] = {x, x-1, x, x+1};
+	int nextY[4] = {y+1, y, y-1, y};
+	int nextHeadings[4] = {DIR_NORTH, DIR_EAST, DIR_SOUTH, DIR_WEST};
+
+	int numMoves = 0;
+	for (int i = 0; i < 4; i++) {
+		if (nextX[i] < 0 || nextX[i] >= MAP_WIDTH ||
+		    nextY[i] < 0 || nextY[i] >= MAP_HEIGHT) {
+			continue;
+		}
+		int target = BitBoard::indexOf(nextX[i], nextY[i]);
+		if (blocked & BitBoard::bitAt(target)) {
+			continue;
+		}
+		targets[numMoves] = target;
+		headings[numMoves] = nextHeadings[i];
+		numMoves++;
+	}
+	return numMoves;
+}
+
+// plain minimax with the game search's rules: no table, no ordering
+// and no cut offs
+float minimax(GameState state, int depth, bool ourTurn) {
+	if (depth == 0) {
+		return state.value;
+	}
+
+	int targets[4];
+	int headings[4];
+	if (!ourTurn && state.them == -1) {
+		return minimax(state, depth-1, true);
+	}
+	int mover = ourTurn ? state.us : state.them;
+	int numMoves = moves(mover, state.blocked, targets, headings);
+	if (numMoves == 0) {
+		// whoever is stuck passes, until both are
+		int other = ourTurn ? state.them : state.us;
+		if (other == -1 || moves(other, state.blocked, targets, headings) == 0) {
+			return state.value;
+		}
+		return minimax(state, depth-1, !ourTurn);
+	}
+
+	float best = ourTurn ? -MINIMAX_INFINITY : MINIMAX_INFINITY;
+	for (int i = 0; i < numMoves; i++) {
+		GameState next = state;
+		next.blocked |= BitBoard::bitAt(targets[i]);
+		if (ourTurn) {
+			next.us = targets[i];
+			next.value += ourValues[targets[i]];
+			if (next.heading != -1 && next.heading != headings[i]) {
+				next.value -= GAME_TURN_PENALTY;
+			}
+			next.heading = headings[i];
+		}
+		else {
+			next.them = targets[i];
+			next.value -= theirValues[targets[i]];
+		}
+
+		float value = minimax(next, depth-1, !ourTurn);
+		if (ourTurn ? value > best : value < best) {
+			best = value;
+		}
+	}
+	return best;
+}
+
+// checks one search against minimax, returning false if they disagree
+bool check(GameSearch *search, BitBoard *board, int us, int them,
+           int *checked) {
+	int move = search->search(board, us, them, SEARCH_BUDGET);
+	GameSearchStats stats = search->getStats();
+	if (move == -1 || !stats.complete) {
+		return true;
+	}
+
+	GameState root;
+	root.us = us;
+	root.them = them;
+	root.blocked = board->blocked | BitBoard::bitAt(us) |
+	               BitBoard::bitAt(them);
+	root.heading = -1;
+	root.value = 0.0;
+	root.hash = 0;
+	float expected = minimax(root, GAME_SEARCH_MAX_DEPTH, true);
+	(*checked)++;
+
+	// and the move it picked must be worth that much too
+	int targets[4];
+	int headings[4];
+	int numMoves = moves(us, root.blocked, targets, headings);
+	GameState next = root;
+	next.us = move;
+	next.blocked |= BitBoard::bitAt(move);
+	next.value = ourValues[move];
+	for (int i = 0; i < numMoves; i++) {
+		if (targets[i] == move) {
+			next.heading = headings[i];
+		}
+	}
+	float moveValue = minimax(next, GAME_SEARCH_MAX_DEPTH - 1, false);
+
+	if (fabs(stats.value - expected) > VALUE_TOLERANCE ||
+	    fabs(moveValue - expected) > VALUE_TOLERANCE) {
+		printf("us %d them %d depth %d: search %f (move %d worth %f), "
+		       "minimax %f\n", us, them, stats.depth, stats.value, move,
+		       moveValue, expected);
+		return false;
+	}
+	return true;
+}
+
+// a pellet we're walled off from isn't worth searching for
+bool checkUnreachable(GameSearch *search) {
+	BitBoard board;
+	board.clear();
+	// wall off the 2x2 corner we start in
+	board.blocked = BitBoard::bitAt(2) | BitBoard::bitAt(9) |
+	                BitBoard::bitAt(14) | BitBoard::bitAt(15);
+	board.pellet = BitBoard::bitAt(BOARD_CELLS - 1);
+	board.points[BOARD_CELLS - 1] = 5;
+
+	int move = search->search(&board, 0, -1, SEARCH_BUDGET);
+	if (move != -1) {
+		printf("walled off pellet: searched and moved to %d\n", move);
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char *argv[]) {
+	LOG.setImportanceLevel(LOG_HIGH);
+
+	int boards = argc > 1 ? atoi(argv[1]) : DEFAULT_BOARDS;
+
+	int mismatches = 0;
+	int checked = 0;
+	int searches = 0;
+	long hits = 0;
+	long probes = 0;
+
+	for (int b = 0; b < boards; b++) {
+		map_obj_t *mapObjs = generateMap(b + 1);
+		Map map(mapObjs, 0, 0);
+		GameSearch search(&map);
+
+		// a copy, so the robots can move without the points changing
+		// and the table is kept from one search to the next
+		BitBoard board = *map.getBoard();
+		for (int i = 0; i < BOARD_CELLS; i++) {
+			ourValues[i] = Path::cellValue(i % MAP_WIDTH, i / MAP_WIDTH,
+			                               board.points[i]);
+			theirValues[i] = board.points[i];
+		}
+
+		int us = BitBoard::indexOf(0, 0);
+		int them = BitBoard::indexOf(MAP_WIDTH-1, MAP_HEIGHT-1);
+		for (int m = 0; m < MOVES_PER_BOARD; m++) {
+			for (int s = 0; s < SEARCHES_PER_MOVE; s++) {
+				if (!check(&search, &board, us, them, &checked)) {
+					mismatches++;
+				}
+				searches++;
+			}
+
+			// we both move the way the search says we would
+			int move = search.search(&board, us, them, SEARCH_BUDGET);
+			if (move == -1) {
+				break;
+			}
+			board.blocked |= BitBoard::bitAt(us);
+			us = move;
+			int theirMove = search.search(&board, them, us, SEARCH_BUDGET);
+			if (theirMove == -1) {
+				break;
+			}
+			board.blocked |= BitBoard::bitAt(them);
+			them = theirMove;
+		}
+
+		TTStats table = search.getTable()->getStats();
+		hits += table.hits;
+		probes += table.probes;
+		freeMap(mapObjs);
+	}
+
+	map_obj_t *mapObjs = generateMap(1);
+	Map map(mapObjs, 0, 0);
+	GameSearch search(&map);
+	if (!checkUnreachable(&search)) {
+		mismatches++;
+	}
+	freeMap(mapObjs);
+
+	printf("boards: %d\tsearches: %d\tchecked: %d\ttable hits: %ld/%ld\n",
+	       boards, searches, checked, hits, probes);
+
+	if (checked == 0) {
+		printf("FAIL: no search saw the end of the game\n");
+		return 1;
+	}
+	if (mismatches > 0) {
+		printf("FAIL: %d searches disagreed with minimax\n", mismatches);
+		return 1;
+	}
+	printf("PASS\n");
+	return 0;
+}
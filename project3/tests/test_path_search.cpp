@@ -0,0 +1,150 @@
+// Times the path search (see MapStrategy::getBestPath) on generated
+// boards at every thread count, and checks that every thread count
+// picks the same path as a single thread. Then reports how deep the
+// time limited search (see MapStrategy::searchPaths) gets in the time
+// it has to pick a move.
+//
+// usage: test_path_search.out [path length] [boards]
+//
+// Exits non-zero if any thread count picks a different path.
+#include "../map_strategy.h"
+#include "../utilities.h"
+#include "../logger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DEFAULT_LENGTH 12
+#define DEFAULT_BOARDS 10
+#define SEARCHES_PER_BOARD 5
+
+// a board like the game's: a few posts and a pellet on most cells,
+// with us in one corner and the opponent in the other
+map_obj_t* generateMap(unsigned int seed) {
+	map_obj_t *head = NULL;
+	for (int x = 0; x < MAP_WIDTH; x++) {
+		for (int y = 0; y < MAP_HEIGHT; y++) {
+			map_obj_t *obj = new map_obj_t;
+			obj->x = x;
+			obj->y = y;
+			obj->points = 0;
+			obj->next = head;
+			head = obj;
+
+			int roll = rand_r(&seed) % 10;
+			if (x == 0 && y == 0) {
+				obj->type = MAP_OBJ_ROBOT_1;
+			}
+			else if (x == MAP_WIDTH-1 && y == MAP_HEIGHT-1) {
+				obj->type = MAP_OBJ_ROBOT_2;
+			}
+			else if (roll == 0) {
+				obj->type = MAP_OBJ_POST;
+			}
+			else if (roll < 3) {
+				obj->type = MAP_OBJ_EMPTY;
+			}
+			else {
+				obj->type = MAP_OBJ_PELLET;
+				obj->points = 1 + rand_r(&seed) % 5;
+			}
+		}
+	}
+	return head;
+}
+
+void freeMap(map_obj_t *map) {
+	while (map != NULL) {
+		map_obj_t *next = map->next;
+		delete map;
+		map = next;
+	}
+}
+
+bool samePath(Path *a, Path *b) {
+	if (a == NULL || b == NULL) {
+		return a == b;
+	}
+	if (a->length() != b->length()) {
+		return false;
+	}
+	for (int i = 0; i < a->length(); i++) {
+		if (a->getCell(i) != b->getCell(i)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char *argv[]) {
+	LOG.setImportanceLevel(LOG_HIGH);
+
+	int length = argc > 1 ? atoi(argv[1]) : DEFAULT_LENGTH;
+	int boards = argc > 2 ? atoi(argv[2]) : DEFAULT_BOARDS;
+
+	double times[PATH_THREADS + 1] = {0.0};
+	long nodes = 0;
+	int mismatches = 0;
+	int depth = 0;
+	double nodesPerSecond = 0.0;
+	double slowest = 0.0;
+
+	for (int board = 0; board < boards; board++) {
+		map_obj_t *mapObjs = generateMap(board + 1);
+		Map map(mapObjs, 0, 0);
+		MapStrategy strategy(&map);
+
+		strategy.setThreads(1);
+		Path single;
+		Path *best = strategy.getBestPath(length);
+		bool found = best != NULL;
+		if (found) {
+			single = *best;
+		}
+		nodes += strategy.getNodes();
+
+		for (int threads = 1; threads <= PATH_THREADS; threads++) {
+			strategy.setThreads(threads);
+			double start = Util::getTime();
+			for (int i = 0; i < SEARCHES_PER_BOARD; i++) {
+				best = strategy.getBestPath(length);
+			}
+			times[threads] += Util::getTime() - start;
+
+			if (!samePath(found ? &single : NULL, best)) {
+				printf("board %d: %d threads picked a different path\n",
+				       board, threads);
+				mismatches++;
+			}
+		}
+
+		strategy.searchPaths(NEXT_CELL_BUDGET);
+		PathSearchStats stats = strategy.getPathStats();
+		depth += stats.depth;
+		nodesPerSecond += stats.nodesPerSecond;
+		if (stats.time > slowest) {
+			slowest = stats.time;
+		}
+
+		freeMap(mapObjs);
+	}
+
+	int searches = boards * SEARCHES_PER_BOARD;
+	printf("path length: %d\tboards: %d\tmean nodes: %ld\n",
+	       length, boards, nodes / boards);
+	for (int threads = 1; threads <= PATH_THREADS; threads++) {
+		printf("threads: %d\tmean time: %f ms\tspeedup: %.2f\n", threads,
+		       times[threads] / searches * 1000.0, times[1] / times[threads]);
+	}
+
+	printf("budget: %.0f ms\tmean depth: %.1f\tmean nodes/s: %.0f\t"
+	       "slowest: %f ms\n", NEXT_CELL_BUDGET * 1000.0, 
+	       (float)depth / boards, nodesPerSecond / boards, slowest * 1000.0);
+
+	if (mismatches > 0) {
+		printf("FAIL: %d searches differed from a single thread\n", mismatches);
+		return 1;
+	}
+	printf("PASS\n");
+	return 0;
+}
@@ -1,8 +1,8 @@
 #include "../PID.h"
 #include <stdio.h>
 
-#define PID_KP 0.8
-#define PID_KI 0.25
+#define PID_KP 0.25
+#define PID_KI 0.8
 #define PID_KD 0.30
 
 #define MIN_ERROR -1.0
@@ -14,13 +14,16 @@ int main() {
     PIDConstants constants = {PID_KP, PID_KI, PID_KD};
     PID *pid = new PID(&constants, MIN_ERROR, MAX_ERROR);
 
+    // a long stretch at full error shouldn't wind the integrator up
+    // past its limit
     error = MAX_ERROR;
-    for (int i = 0; i < 10; i++) {
-        pid->updatePID(error);
+    for (int i = 0; i < 100; i++) {
+        pid->updatePID(error, PID_SAMPLE_TIME);
     }
+    printf("Integrator after saturation: %f\n", pid->currentIntegratorError());
 
     for (int i = 0; i < 10; i++) {
-        gain = pid->updatePID(error);
+        gain = pid->updatePID(error, PID_SAMPLE_TIME);
         speed = 10 - 9 * gain;
 
         printf("Error: %f\t Gain: %f\t Speed: %f\n",
@@ -29,5 +32,22 @@ int main() {
         error -= 0.1;
     }
 
+    // the same error ramp at twice the rate should give about the
+    // same gains, since the gains are per PID_SAMPLE_TIME
+    pid->flushPID();
+    error = MAX_ERROR;
+    for (int i = 0; i < 20; i++) {
+        gain = pid->updatePID(error, PID_SAMPLE_TIME / 2);
+        speed = 10 - 9 * gain;
+
+        if (i % 2 == 1) {
+            printf("Error: %f\t Gain: %f\t Speed: %f\t(half dt)\n",
+                   error, gain, speed);
+        }
+
+        error -= 0.05;
+    }
+
+    delete pid;
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,233 @@
+// Drives a made up robot across a room boundary, with known north star
+// readings from both rooms, and checks that the blended pose (see
+// RoomBlender) moves smoothly across it. Then replays recorded north
+// star logs across room transitions and measures how far the global
+// position jumps when the room changes, with and without blending.
+//
+// usage: test_room_blend.out [robot name] [log base path]...
+//
+// Exits non-zero if the blended pose jumps at the made up boundary, or
+// if blending makes the largest jump in the logs worse.
+#include "../calibration.h"
+#include "../room_blender.h"
+#include "../utilities.h"
+#include "../logger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string>
+#include <fstream>
+
+#define LOG_DIR "../../project1/data/logs/"
+
+const char *DEFAULT_LOGS[] = {
+    LOG_DIR "gortDriveStraightRoom2/gortDriveStraightRoom2",
+    LOG_DIR "gortDriveStraightRoom2-3transition/gortDriveStraightRoom2-3transition",
+    LOG_DIR "gortDriveStraightRoom3-4transition/gortDriveStraightRoom3-4transition",
+    LOG_DIR "gortDriveStraightRoom4-5transition/gortDriveStraightRoom4-5transition"
+};
+
+// the made up drive: straight along x from room 3 into room 4, a
+// couple of cm per reading, with the beacons flickering back and forth
+// for a while in the middle
+#define DRIVE_START_X 250.0
+#define DRIVE_START_Y 300.0
+#define DRIVE_STEP 2.0
+#define DRIVE_READINGS 60
+#define BEACON_STRENGTH 13000
+#define FLICKER_START 25
+#define FLICKER_END 35
+
+// how far off room 4's calibration is, so its readings disagree with
+// room 3's about where the robot is
+#define ROOM_4_ERROR_X 6.0
+#define ROOM_4_ERROR_Y -4.0
+
+// how far the blended pose can move between readings, beyond how far
+// the robot really moved, without it counting as a jump
+#define MAX_BLEND_STEP_ERROR 3.0
+
+typedef struct {
+    int transitions;
+    float maxJump;
+    float totalJump;
+} JumpStats;
+
+void addJump(JumpStats *stats, Pose *prev, Pose *cur) {
+    float dx = cur->getX() - prev->getX();
+    float dy = cur->getY() - prev->getY();
+    float jump = sqrt(dx*dx + dy*dy);
+    stats->transitions++;
+    stats->totalJump += jump;
+    if (jump > stats->maxJump) {
+        stats->maxJump = jump;
+    }
+}
+
+// the raw reading the given room's beacon gives for a global pose
+void readingFor(Calibration *calibration, int room, Pose *truth,
+                float *x, float *y, float *theta) {
+    Pose raw(truth->getX(), truth->getY(), 0);
+    if (room == ROOM_4) {
+        raw.translate(ROOM_4_ERROR_X, ROOM_4_ERROR_Y);
+    }
+    calibration->toRoom(room, &raw);
+    RoomCalibration *cal = calibration->getRoom(room);
+    *x = raw.getX();
+    *y = raw.getY();
+    *theta = Util::normalizeTheta(truth->getTheta() + cal->rotation + 
+                                  cal->thetaShift);
+}
+
+float stepError(Pose *prev, Pose *cur, Pose *prevTruth, Pose *truth) {
+    float dx = (cur->getX() - prev->getX()) - 
+               (truth->getX() - prevTruth->getX());
+    float dy = (cur->getY() - prev->getY()) - 
+               (truth->getY() - prevTruth->getY());
+    return sqrt(dx*dx + dy*dy);
+}
+
+// drives across the made up boundary, returning the largest step error
+// with and without blending
+void driveAcross(Calibration *calibration, float *single, float *blended) {
+    RoomBlender blender(calibration);
+    Pose prevTruth(0, 0, 0), prevSingle(0, 0, 0), prevBlended(0, 0, 0);
+    *single = 0.0;
+    *blended = 0.0;
+
+    for (int i = 0; i < DRIVE_READINGS; i++) {
+        Pose truth(DRIVE_START_X + i * DRIVE_STEP, DRIVE_START_Y, 0);
+
+        int room = i < FLICKER_START ? ROOM_3 : ROOM_4;
+        if (i >= FLICKER_START && i < FLICKER_END && i % 2 == 1) {
+            room = ROOM_3;
+        }
+        // room 3's beacon fades as room 4's gets stronger
+        float fade = (float)i / (DRIVE_READINGS - 1);
+        int strength = (int)(BEACON_STRENGTH * 
+                             (room == ROOM_3 ? 1.0 - fade / 2 : 0.5 + fade / 2));
+
+        float x, y, theta;
+        readingFor(calibration, room, &truth, &x, &y, &theta);
+        Pose curSingle(x, y, theta);
+        calibration->toGlobal(room, &curSingle);
+        Pose curBlended(0, 0, 0);
+        blender.update(room, x, y, theta, strength, &curBlended);
+
+        if (i > 0) {
+            float error = stepError(&prevSingle, &curSingle, &prevTruth, &truth);
+            *single = error > *single ? error : *single;
+            error = stepError(&prevBlended, &curBlended, &prevTruth, &truth);
+            *blended = error > *blended ? error : *blended;
+        }
+        prevTruth = truth;
+        prevSingle = curSingle;
+        prevBlended = curBlended;
+    }
+}
+
+int replay(std::string base, Calibration *calibration,
+           JumpStats *single, JumpStats *blended) {
+    std::ifstream nsFile((base + "_ns_raw").c_str());
+    std::ifstream roomFile((base + "_room").c_str());
+    std::ifstream signalFile((base + "_signal").c_str());
+
+    RoomBlender blender(calibration);
+    Pose prevSingle(0, 0, 0), prevBlended(0, 0, 0);
+    int prevRoom = -1;
+    int numSamples = 0;
+
+    std::string nsLine, roomLine, signalLine;
+    while (std::getline(nsFile, nsLine) &&
+           std::getline(roomFile, roomLine) &&
+           std::getline(signalFile, signalLine)) {
+        float x, y, theta;
+        if (sscanf(nsLine.c_str(), "%f,%f,%f", &x, &y, &theta) != 3) {
+            continue;
+        }
+        int room = atoi(roomLine.c_str()) - 2;
+        int strength = atoi(signalLine.c_str());
+        if (!calibration->hasRoom(room)) {
+            continue;
+        }
+
+        Pose curSingle(x, y, theta);
+        calibration->toGlobal(room, &curSingle);
+        Pose curBlended(0, 0, 0);
+        blender.update(room, x, y, theta, strength, &curBlended);
+
+        if (prevRoom != -1 && room != prevRoom) {
+            addJump(single, &prevSingle, &curSingle);
+            addJump(blended, &prevBlended, &curBlended);
+        }
+
+        prevSingle = curSingle;
+        prevBlended = curBlended;
+        prevRoom = room;
+        numSamples++;
+    }
+
+    return numSamples;
+}
+
+int main(int argc, char *argv[]) {
+    LOG.setImportanceLevel(LOG_HIGH);
+
+    std::string robot = argc > 1 ? argv[1] : "gort";
+    Calibration calibration("../" + Calibration::fileNameFor(Util::nameFrom(robot)));
+
+    if (!calibration.hasRoom(ROOM_3) || !calibration.hasRoom(ROOM_4)) {
+        printf("FAIL: %s has no calibration for rooms 3 and 4\n", 
+               calibration.getFileName().c_str());
+        return 1;
+    }
+
+    float singleStep, blendedStep;
+    driveAcross(&calibration, &singleStep, &blendedStep);
+    printf("made up boundary:\tsingle room step error: %f cm\t"
+           "blended: %f cm\n", singleStep, blendedStep);
+    if (singleStep <= MAX_BLEND_STEP_ERROR) {
+        printf("FAIL: the rooms don't disagree enough to test blending\n");
+        return 1;
+    }
+    if (blendedStep > MAX_BLEND_STEP_ERROR) {
+        printf("FAIL: the blended pose jumped %f cm at the boundary\n", 
+               blendedStep);
+        return 1;
+    }
+
+    JumpStats single = {0, 0.0, 0.0};
+    JumpStats blended = {0, 0.0, 0.0};
+    int numSamples = 0;
+
+    if (argc > 2) {
+        for (int i = 2; i < argc; i++) {
+            numSamples += replay(argv[i], &calibration, &single, &blended);
+        }
+    }
+    else {
+        for (int i = 0; i < 4; i++) {
+            numSamples += replay(DEFAULT_LOGS[i], &calibration, &single, &blended);
+        }
+    }
+
+    printf("samples: %d\ttransitions: %d\n", numSamples, single.transitions);
+    if (single.transitions == 0) {
+        printf("no room transitions in the logs, nothing to compare\n");
+        printf("PASS\n");
+        return 0;
+    }
+
+    printf("single room:\tmax jump: %f cm\tmean jump: %f cm\n",
+           single.maxJump, single.totalJump / single.transitions);
+    printf("blended:\tmax jump: %f cm\tmean jump: %f cm\n",
+           blended.maxJump, blended.totalJump / blended.transitions);
+
+    if (blended.maxJump > single.maxJump) {
+        printf("FAIL: blending made the largest jump worse\n");
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,126 @@
+// Replays approaches to a cell against a robot fitted from recorded
+// north star logs (see PlantModel) and measures how far from the cell
+// the robot ends up once it has come to rest, stopping either once it's
+// within MAX_DIST_ERROR or once it's within its predicted stop distance
+// (see StopModel).
+//
+// usage: test_stop_model.out [drive log]...
+//
+// Exits non-zero if stopping early makes the mean arrival error worse.
+#include "../plant_model.h"
+#include "../stop_model.h"
+#include "../constants.h"
+#include "../logger.h"
+
+#include <stdio.h>
+#include <math.h>
+
+#define LOG_DIR "../../project1/data/logs/"
+#define TURN_LOG LOG_DIR "spinleft_middle_room2/spinleft_middle_room2.dat"
+
+const char *DEFAULT_LOGS[] = {
+    LOG_DIR "drive3mstop/drive3mstop.dat",
+    LOG_DIR "move/move_ns_raw.dat"
+};
+
+const float TARGETS[] = {65.0, 130.0, 195.0}; // cm, one to three cells
+#define NUM_TARGETS 3
+
+#define MAX_APPROACH_TIME 30.0 // seconds
+
+typedef struct {
+    int approaches;
+    float totalError;
+    float maxError;
+    float totalTime;
+} ArrivalStats;
+
+// drives at the level's speed until the stop distance says to stop,
+// then lets the robot come to rest
+void approach(PlantModel *plant, int level, float target,
+              float stopDistance, float settleTime, ArrivalStats *stats) {
+    float tick = 1.0 / CONTROL_RATE;
+    float speed = SPEED_FORWARD[level];
+    float distance = 0.0;
+    float time = 0.0;
+
+    plant->reset();
+    while (target - distance > stopDistance && time < MAX_APPROACH_TIME) {
+        distance += plant->run(speed, tick);
+        time += tick;
+    }
+    distance += plant->run(0.0, settleTime);
+    time += settleTime;
+
+    float error = fabs(target - distance);
+    stats->approaches++;
+    stats->totalError += error;
+    stats->totalTime += time;
+    if (error > stats->maxError) {
+        stats->maxError = error;
+    }
+}
+
+void printStats(const char *name, ArrivalStats *stats) {
+    printf("%s\tmean error: %f cm\tmax error: %f cm\tmean time: %f s\n",
+           name, stats->totalError / stats->approaches, stats->maxError,
+           stats->totalTime / stats->approaches);
+}
+
+int main(int argc, char *argv[]) {
+    LOG.setImportanceLevel(LOG_HIGH);
+
+    double sampleTime;
+    PlantModel turn;
+    if (!turn.fit(TURN_LOG, true, &sampleTime)) {
+        printf("unable to fit %s\n", TURN_LOG);
+        return 1;
+    }
+
+    ArrivalStats baseline = {0, 0.0, 0.0, 0.0};
+    ArrivalStats predicted = {0, 0.0, 0.0, 0.0};
+
+    int numLogs = argc > 1 ? argc - 1 : 2;
+    for (int i = 0; i < numLogs; i++) {
+        const char *log = argc > 1 ? argv[i + 1] : DEFAULT_LOGS[i];
+        PlantModel plant;
+        if (!plant.fit(log, false, &sampleTime)) {
+            printf("unable to fit %s\n", log);
+            continue;
+        }
+        printf("%s: dead time %f s, time constant %f s\n",
+               log, plant.getDeadTime(), plant.getTimeConstant());
+
+        StopModel stops;
+        for (int level = 1; level < NUM_SPEEDS; level++) {
+            stops.set(level, plant.getStopDistance(SPEED_FORWARD[level]),
+                      plant.getDeadTime() + 3 * plant.getTimeConstant());
+        }
+
+        for (int level = 1; level < NUM_SPEEDS; level++) {
+            float settleTime = stops.getSettleTime(level);
+            for (int t = 0; t < NUM_TARGETS; t++) {
+                approach(&plant, level, TARGETS[t], MAX_DIST_ERROR,
+                         settleTime, &baseline);
+                approach(&plant, level, TARGETS[t],
+                         stops.getStopDistance(level), settleTime, &predicted);
+            }
+        }
+    }
+
+    if (baseline.approaches == 0) {
+        printf("no logs could be fit, nothing to compare\n");
+        return 1;
+    }
+
+    printf("approaches: %d\n", baseline.approaches);
+    printStats("baseline:", &baseline);
+    printStats("predicted:", &predicted);
+
+    if (predicted.totalError > baseline.totalError) {
+        printf("FAIL: stopping early made the mean arrival error worse\n");
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,234 @@
+// Checks the travel table (see TravelTable) against Bellman-Ford on
+// generated boards: the time from every cell, facing every way, to
+// every other cell, and that the first move it gives is a step towards
+// it. Then checks that the table is only worked out again when a cell
+// becomes blocked, not when only points change.
+//
+// usage: test_travel_table.out [boards]
+//
+// Exits non-zero if the table disagrees with Bellman-Ford, or is
+// worked out again when it didn't need to be (or not when it did).
+#include "../travel_table.h"
+#include "../utilities.h"
+#include "../logger.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define DEFAULT_BOARDS 20
+#define TIME_TOLERANCE 0.001 // seconds
+
+// a board like the game's: a few posts and a pellet on most cells,
+// with us in one corner and the opponent in the other
+map_obj_t* generateMap(unsigned int seed) {
+	map_obj_t *head = NULL;
+	for (int x = 0; x < MAP_WIDTH; x++) {
+		for (int y = 0; y < MAP_HEIGHT; y++) {
+			map_obj_t *obj = new map_obj_t;
+			obj->x = x;
+			obj->y = y;
+			obj->points = 0;
+			obj->next = head;
+			head = obj;
+
+			int roll = rand_r(&seed) % 10;
+			if (x == 0 && y == 0) {
+				obj->type = MAP_OBJ_ROBOT_1;
+			}
+			else if (x == MAP_WIDTH-1 && y == MAP_HEIGHT-1) {
+				obj->type = MAP_OBJ_ROBOT_2;
+			}
+			else if (roll < 2) {
+				obj->type = MAP_OBJ_POST;
+			}
+			else if (roll < 4) {
+				obj->type = MAP_OBJ_EMPTY;
+			}
+			else {
+				obj->type = MAP_OBJ_PELLET;
+				obj->points = 1 + rand_r(&seed) % 5;
+			}
+		}
+	}
+	return head;
+}
+
+void freeMap(map_obj_t *map) {
+	while (map != NULL) {
+		map_obj_t *next = map->next;
+		delete map;
+		map = next;
+	}
+}
+
+// the quickest time from a cell, facing a way (heading index), to
+// every cell, by Bellman-Ford over (cell, heading) states
+void bellmanFord(uint64_t blocked, int from, int heading, float *times) {
+	float drive = TravelTable::driveTime();
+	float turn = TravelTable::turnTime();
+
+	float time[TRAVEL_STATES];
+	for (int i = 0; i < TRAVEL_STATES; i++) {
+		time[i] = TRAVEL_UNREACHABLE;
+	}
+	time[from * TRAVEL_HEADINGS + heading] = 0.0;
+
+	// north, east, south and west, in heading index order
+	int offsetX[TRAVEL_HEADINGS] = {0, -1, 0, 1};
+	int offsetY[TRAVEL_HEADINGS] = {1, 0, -1, 0};
+	for (int round = 0; round < TRAVEL_STATES; round++) {
+		bool relaxed = false;
+		for (int state = 0; state < TRAVEL_STATES; state++) {
+			if (time[state] >= TRAVEL_UNREACHABLE) {
+				continue;
+			}
+			int cell = state / TRAVEL_HEADINGS;
+			int h = state % TRAVEL_HEADINGS;
+			for (int next = 0; next < TRAVEL_HEADINGS; next++) {
+				int x = cell % MAP_WIDTH + offsetX[next];
+				int y = cell / MAP_WIDTH + offsetY[next];
+				if (x < 0 || x >= MAP_WIDTH || y < 0 || y >= MAP_HEIGHT ||
+				    (blocked & BitBoard::bitAt(BitBoard::indexOf(x, y)))) {
+					continue;
+				}
+				int turns = 0;
+				if (next != h) {
+					turns = (next + 2) % TRAVEL_HEADINGS == h ? 2 : 1;
+				}
+				int nextState = BitBoard::indexOf(x, y) * TRAVEL_HEADINGS + next;
+				float nextTime = time[state] + turns * turn + drive;
+				if (nextTime < time[nextState]) {
+					time[nextState] = nextTime;
+					relaxed = true;
+				}
+			}
+		}
+		if (!relaxed) {
+			break;
+		}
+	}
+
+	for (int to = 0; to < BOARD_CELLS; to++) {
+		times[to] = TRAVEL_UNREACHABLE;
+		for (int h = 0; h < TRAVEL_HEADINGS; h++) {
+			if (time[to * TRAVEL_HEADINGS + h] < times[to]) {
+				times[to] = time[to * TRAVEL_HEADINGS + h];
+			}
+		}
+	}
+	times[from] = 0.0;
+}
+
+// compares the whole table to Bellman-Ford, returning the mismatches
+int checkTable(TravelTable *table, uint64_t blocked) {
+	int headings[TRAVEL_HEADINGS] = {DIR_NORTH, DIR_EAST, DIR_SOUTH, DIR_WEST};
+	int mismatches = 0;
+
+	for (int from = 0; from < BOARD_CELLS; from++) {
+		for (int h = 0; h < TRAVEL_HEADINGS; h++) {
+			float expected[BOARD_CELLS];
+			bellmanFord(blocked, from, h, expected);
+
+			for (int to = 0; to < BOARD_CELLS; to++) {
+				float time = table->getTime(from, headings[h], to);
+				int first = table->getFirstMove(from, headings[h], to);
+				if (fabs(time - expected[to]) > TIME_TOLERANCE) {
+					printf("%d facing %d to %d: table %f, Bellman-Ford %f\n",
+					       from, headings[h], to, time, expected[to]);
+					mismatches++;
+					continue;
+				}
+				if (from == to || expected[to] >= TRAVEL_UNREACHABLE) {
+					continue;
+				}
+
+				// the first move is an open cell next to us, and the
+				// rest of the way from there is no slower than it says
+				int dx = abs(first % MAP_WIDTH - from % MAP_WIDTH);
+				int dy = abs(first / MAP_WIDTH - from / MAP_WIDTH);
+				if (first < 0 || dx + dy != 1 ||
+				    (blocked & BitBoard::bitAt(first)) ||
+				    table->getTime(first, -1, to) >
+				    time - TravelTable::driveTime() + TIME_TOLERANCE) {
+					printf("%d facing %d to %d: bad first move %d\n",
+					       from, headings[h], to, first);
+					mismatches++;
+				}
+			}
+		}
+	}
+	return mismatches;
+}
+
+int main(int argc, char *argv[]) {
+	LOG.setImportanceLevel(LOG_HIGH);
+
+	int boards = argc > 1 ? atoi(argv[1]) : DEFAULT_BOARDS;
+
+	int mismatches = 0;
+	int badRebuilds = 0;
+	double rebuildTime = 0.0;
+
+	for (int b = 0; b < boards; b++) {
+		map_obj_t *mapObjs = generateMap(b + 1);
+		Map map(mapObjs, 0, 0);
+		TravelTable table(&map);
+		BitBoard *board = map.getBoard();
+
+		double start = Util::getTime();
+		table.getTime(0, -1, 0);
+		rebuildTime += Util::getTime() - start;
+		mismatches += checkTable(&table, board->blocked);
+
+		// a pellet's points change, the way Map tells its listeners
+		int pellet = -1;
+		for (int i = 0; i < BOARD_CELLS && pellet == -1; i++) {
+			if (board->pellet & ~board->blocked & BitBoard::bitAt(i)) {
+				pellet = i;
+			}
+		}
+		if (pellet == -1) {
+			freeMap(mapObjs);
+			continue;
+		}
+		int rebuilds = table.getRebuilds();
+		MapChanges changes;
+		changes.changed = BitBoard::bitAt(pellet);
+		changes.blocked = 0;
+		changes.points = BitBoard::bitAt(pellet);
+		changes.opponentMoved = false;
+		changes.opponentCell = map.getOpponentCell();
+		board->points[pellet]++;
+		table.mapChanged(&changes);
+		table.getBestTarget(0, -1);
+		if (table.getRebuilds() != rebuilds) {
+			printf("board %d: rebuilt when only points changed\n", b);
+			badRebuilds++;
+		}
+
+		// then the pellet's cell becomes blocked
+		board->blocked |= BitBoard::bitAt(pellet);
+		changes.blocked = BitBoard::bitAt(pellet);
+		table.mapChanged(&changes);
+		table.getBestTarget(0, -1);
+		if (table.getRebuilds() != rebuilds + 1) {
+			printf("board %d: not rebuilt when a cell became blocked\n", b);
+			badRebuilds++;
+		}
+		mismatches += checkTable(&table, board->blocked);
+
+		freeMap(mapObjs);
+	}
+
+	printf("boards: %d\tmean rebuild: %f ms\n", boards,
+	       rebuildTime / boards * 1000.0);
+
+	if (mismatches > 0 || badRebuilds > 0) {
+		printf("FAIL: %d times disagreed with Bellman-Ford, %d bad rebuilds\n",
+		       mismatches, badRebuilds);
+		return 1;
+	}
+	printf("PASS\n");
+	return 0;
+}
@@ -0,0 +1,81 @@
+// Decodes the ticks of ideal pure motions (see WheelKinematics) and
+// checks that each comes out on its own axis: a turn as rotation only,
+// a strafe as lateral only, and forward as WE_FORWARD_GAIN of the
+// distance, with every wheel and with each single wheel fault.
+//
+// usage: test_wheel_kinematics.out
+//
+// Exits non-zero if any motion leaks into another axis.
+#include "../wheel_kinematics.h"
+#include "../constants.h"
+#include "../logger.h"
+
+#include <stdio.h>
+#include <math.h>
+
+#define TOLERANCE 0.001
+
+const char *AXIS_NAMES[] = {"lateral", "forward", "rotation"};
+
+typedef struct {
+    const char *name;
+    float ticks[3];     // left, right, rear
+    float expected[3];  // lateral, forward, rotation
+    bool needsAllWheels;
+} PureMotion;
+
+const PureMotion MOTIONS[] = {
+    {"turn",    {-1.0, 1.0, -1.0},               {0.0, 0.0, 1.0}, false},
+    {"strafe",  {0.5, -0.5, -1.0},               {1.0, 0.0, 0.0}, true},
+    {"forward", {0.866025404, 0.866025404, 0.0}, {0.0, WE_FORWARD_GAIN, 0.0}, false}
+};
+#define NUM_MOTIONS 3
+
+const int FAULTS[] = {WE_FAULT_NONE, WE_FAULT_LEFT, WE_FAULT_RIGHT, WE_FAULT_REAR};
+#define NUM_FAULTS 4
+
+int main() {
+    LOG.setImportanceLevel(LOG_HIGH);
+
+    int failures = 0;
+    for (int f = 0; f < NUM_FAULTS; f++) {
+        float kinematics[9];
+        if (!WheelKinematics::build(FAULTS[f], kinematics)) {
+            printf("faults %d: no kinematics\n", FAULTS[f]);
+            failures++;
+            continue;
+        }
+
+        for (int m = 0; m < NUM_MOTIONS; m++) {
+            const PureMotion *motion = &MOTIONS[m];
+            if (motion->needsAllWheels && FAULTS[f] != WE_FAULT_NONE) {
+                continue;
+            }
+
+            float decoded[3];
+            for (int i = 0; i < 3; i++) {
+                decoded[i] = 0.0;
+                for (int j = 0; j < 3; j++) {
+                    decoded[i] += kinematics[i*3 + j] * motion->ticks[j];
+                }
+            }
+
+            printf("faults %d %s:\tlateral %f\tforward %f\trotation %f\n",
+                   FAULTS[f], motion->name, decoded[0], decoded[1], decoded[2]);
+            for (int i = 0; i < 3; i++) {
+                if (fabs(decoded[i] - motion->expected[i]) > TOLERANCE) {
+                    printf("FAIL: %s gave %f %s, expected %f\n", motion->name,
+                           decoded[i], AXIS_NAMES[i], motion->expected[i]);
+                    failures++;
+                }
+            }
+        }
+    }
+
+    if (failures > 0) {
+        printf("FAIL: %d axes wrong\n", failures);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,215 @@
+/**
+ * trajectory.cpp
+ * 
+ * @brief 
+ *      This class records a run's poses over time. x, y, theta and the
+ *      time of each pose are kept in their own contiguous arrays, so a
+ *      whole run costs a handful of allocations, windows of it can be
+ *      summarized quickly, and the columns can be handed off (or written
+ *      out) without copying.
+ * 
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#include "trajectory.h"
+#include "logger.h"
+#include <stdio.h>
+#include <math.h>
+
+Trajectory::Trajectory(int capacity) {
+    _x.reserve(capacity);
+    _y.reserve(capacity);
+    _theta.reserve(capacity);
+    _time.reserve(capacity);
+}
+
+Trajectory::~Trajectory() {}
+
+/**************************************
+ * Definition: Adds a pose to the end of the trajectory
+ *
+ * Parameters: pointer to the pose and the time it was taken at
+ *             (in seconds)
+ **************************************/
+void Trajectory::append(Pose *pose, double time) {
+    append(pose->getX(), pose->getY(), pose->getTheta(), time);
+}
+
+/**************************************
+ * Definition: Adds a pose to the end of the trajectory
+ *
+ * Parameters: x, y and theta as floats and the time it was 
+ *             taken at (in seconds)
+ **************************************/
+void Trajectory::append(float x, float y, float theta, double time) {
+    _x.push_back(x);
+    _y.push_back(y);
+    _theta.push_back(theta);
+    _time.push_back(time);
+}
+
+/**************************************
+ * Definition: Forgets every pose, keeping the memory for reuse
+ **************************************/
+void Trajectory::clear() {
+    _x.clear();
+    _y.clear();
+    _theta.clear();
+    _time.clear();
+}
+
+/**************************************
+ * Definition: Returns the number of poses recorded
+ **************************************/
+int Trajectory::size() {
+    return _x.size();
+}
+
+/**************************************
+ * Definition: Returns a copy of a recorded pose
+ *
+ * Parameters: int index of the pose
+ **************************************/
+Pose Trajectory::getPose(int index) {
+    return Pose(_x[index], _y[index], _theta[index]);
+}
+
+/**************************************
+ * Definition: Return the recorded columns. The pointers are only
+ *             good until the next append.
+ **************************************/
+const float* Trajectory::getX() {
+    return _x.empty() ? NULL : &_x[0];
+}
+
+const float* Trajectory::getY() {
+    return _y.empty() ? NULL : &_y[0];
+}
+
+const float* Trajectory::getTheta() {
+    return _theta.empty() ? NULL : &_theta[0];
+}
+
+const double* Trajectory::getTime() {
+    return _time.empty() ? NULL : &_time[0];
+}
+
+/**************************************
+ * Definition: Summarizes a window of the trajectory
+ *
+ * Parameters: int index of the first pose, the number of poses and
+ *             a pointer to store the stats in
+ *
+ * Returns:    false if the window is empty or out of range
+ **************************************/
+bool Trajectory::getStats(int first, int count, TrajectoryStats *stats) {
+    if (first < 0 || count <= 0 || first + count > size()) {
+        return false;
+    }
+    int last = first + count;
+
+    double sumX = 0.0;
+    double sumY = 0.0;
+    double sumSin = 0.0;
+    double sumCos = 0.0;
+    double distance = 0.0;
+    for (int i = first; i < last; i++) {
+        sumX += _x[i];
+        sumY += _y[i];
+        sumSin += sin(_theta[i]);
+        sumCos += cos(_theta[i]);
+        if (i > first) {
+            float dx = _x[i] - _x[i-1];
+            float dy = _y[i] - _y[i-1];
+            distance += sqrt(dx*dx + dy*dy);
+        }
+    }
+    double meanX = sumX / count;
+    double meanY = sumY / count;
+
+    double sumSquaresX = 0.0;
+    double sumSquaresY = 0.0;
+    for (int i = first; i < last; i++) {
+        sumSquaresX += (_x[i] - meanX) * (_x[i] - meanX);
+        sumSquaresY += (_y[i] - meanY) * (_y[i] - meanY);
+    }
+
+    stats->count = count;
+    stats->meanX = meanX;
+    stats->meanY = meanY;
+    stats->meanTheta = Util::normalizeTheta(atan2(sumSin, sumCos));
+    stats->varianceX = sumSquaresX / count;
+    stats->varianceY = sumSquaresY / count;
+    stats->thetaSpread = 1.0 - sqrt(sumSin*sumSin + sumCos*sumCos) / count;
+    stats->distance = distance;
+    stats->duration = _time[last-1] - _time[first];
+    return true;
+}
+
+/**************************************
+ * Definition: Summarizes the poses recorded in the last few seconds
+ *
+ * Parameters: double number of seconds (counted back from the 
+ *             newest pose) and a pointer to store the stats in
+ *
+ * Returns:    false if nothing has been recorded
+ **************************************/
+bool Trajectory::getRecentStats(double seconds, TrajectoryStats *stats) {
+    int last = size();
+    if (last == 0) {
+        return false;
+    }
+    double start = _time[last-1] - seconds;
+    // times only go up, so search for the start of the window
+    int lo = 0;
+    int hi = last - 1;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (_time[mid] < start) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return getStats(lo, last - lo, stats);
+}
+
+/**************************************
+ * Definition: Writes the trajectory out as binary columns: the
+ *             number of poses (int) followed by the x, y and theta
+ *             columns (floats) and the time column (doubles)
+ *
+ * Parameters: string name of the file to write
+ *
+ * Returns:    false if the file couldn't be written
+ **************************************/
+bool Trajectory::write(std::string fileName) {
+    FILE *file = fopen(fileName.c_str(), "wb");
+    if (file == NULL) {
+        LOG.write(LOG_HIGH, "trajectory", 
+                  "unable to open %s for writing", fileName.c_str());
+        return false;
+    }
+
+    int count = size();
+    bool success = fwrite(&count, sizeof(int), 1, file) == 1;
+    if (success && count > 0) {
+        size_t samples = count;
+        success = fwrite(getX(), sizeof(float), count, file) == samples &&
+                  fwrite(getY(), sizeof(float), count, file) == samples &&
+                  fwrite(getTheta(), sizeof(float), count, file) == samples &&
+                  fwrite(getTime(), sizeof(double), count, file) == samples;
+    }
+    fclose(file);
+
+    if (!success) {
+        LOG.write(LOG_HIGH, "trajectory", 
+                  "unable to write %s", fileName.c_str());
+    }
+    return success;
+}
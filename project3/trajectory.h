@@ -0,0 +1,61 @@
+/**
+ * trajectory.h
+ * 
+ * @brief 
+ *      This class records a run's poses over time. x, y, theta and the
+ *      time of each pose are kept in their own contiguous arrays, so a
+ *      whole run costs a handful of allocations, windows of it can be
+ *      summarized quickly, and the columns can be handed off (or written
+ *      out) without copying.
+ * 
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#ifndef CS1567_TRAJECTORY_H
+#define CS1567_TRAJECTORY_H
+
+#include "pose.h"
+#include <string>
+#include <vector>
+
+// poses reserved up front (about 10 minutes of updates at 10Hz)
+#define TRAJECTORY_CAPACITY 6000
+
+typedef struct {
+    int count;
+    float meanX, meanY;
+    float meanTheta;      // circular mean
+    float varianceX, varianceY;
+    float thetaSpread;    // 1 - mean resultant length, 0 when all agree
+    float distance;       // path length through the window
+    double duration;      // seconds from first to last pose
+} TrajectoryStats;
+
+class Trajectory {
+public:
+    Trajectory(int capacity = TRAJECTORY_CAPACITY);
+    ~Trajectory();
+    void append(Pose *pose, double time);
+    void append(float x, float y, float theta, double time);
+    void clear();
+    int size();
+    Pose getPose(int index);
+    const float* getX();
+    const float* getY();
+    const float* getTheta();
+    const double* getTime();
+    bool getStats(int first, int count, TrajectoryStats *stats);
+    bool getRecentStats(double seconds, TrajectoryStats *stats);
+    bool write(std::string fileName);
+private:
+    std::vector<float> _x;
+    std::vector<float> _y;
+    std::vector<float> _theta;
+    std::vector<double> _time;
+};
+
+#endif
@@ -0,0 +1,123 @@
+/**
+ * transposition_table.cpp
+ *
+ * @brief
+ *      This class remembers what the game search found out about the
+ *      states it has searched, by their Zobrist hash (see Zobrist), so
+ *      a state reached again by a different order of the same moves
+ *      is looked up instead of searched again.
+ *
+ *      It's a fixed size table, a slot per hash. A new result takes
+ *      the slot if it's empty, left over from an older search, or the
+ *      new result searched at least as deep.
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#include "transposition_table.h"
+#include "logger.h"
+
+#include <string.h>
+
+TranspositionTable::TranspositionTable() {
+	_entries = new TTEntry[TT_SIZE];
+	clear();
+}
+
+TranspositionTable::~TranspositionTable() {
+	delete[] _entries;
+}
+
+/**************************************
+ * Definition: Forgets every state and resets the counters
+ **************************************/
+void TranspositionTable::clear() {
+	memset(_entries, 0, TT_SIZE * sizeof(TTEntry));
+	memset(&_stats, 0, sizeof(TTStats));
+	_age = 1;
+}
+
+/**************************************
+ * Definition: Starts a new search. What older searches stored can
+ *             still be found, but anything new can replace it.
+ **************************************/
+void TranspositionTable::newSearch() {
+	_age++;
+	if (_age == 0) {
+		// wrapped around, so nothing can be told apart by age anymore
+		clear();
+	}
+}
+
+/**************************************
+ * Definition: Looks up a state
+ *
+ * Parameters: the state's hash and where to copy its entry to
+ *
+ * Returns:    true if the state was found
+ **************************************/
+bool TranspositionTable::probe(uint64_t key, TTEntry *entry) {
+	_stats.probes++;
+	TTEntry *slot = &_entries[key & (TT_SIZE - 1)];
+	if (slot->age == 0 || slot->key != key) {
+		return false;
+	}
+	_stats.hits++;
+	*entry = *slot;
+	return true;
+}
+
+/**************************************
+ * Definition: Stores what was found out about a state, if it's
+ *             worth more than what's in its slot
+ *
+ * Parameters: the state's hash, the plies searched below it, the
+ *             value still to be gained from it, what kind of bound
+ *             that is, the best move (-1 if none) and whether it was
+ *             searched to the end of the game
+ **************************************/
+void TranspositionTable::store(uint64_t key, int depth, float value, 
+                               int bound, int move, bool complete) {
+	TTEntry *slot = &_entries[key & (TT_SIZE - 1)];
+	if (slot->age == _age && slot->depth > depth) {
+		return;
+	}
+
+	if (slot->age != 0 && slot->key != key) {
+		_stats.replaced++;
+	}
+	_stats.stores++;
+
+	slot->key = key;
+	slot->value = value;
+	slot->depth = depth;
+	slot->move = move;
+	slot->bound = bound;
+	slot->age = _age;
+	slot->complete = complete;
+}
+
+/**************************************
+ * Definition: Returns the counters since the table was last cleared
+ **************************************/
+TTStats TranspositionTable::getStats() {
+	return _stats;
+}
+
+/**************************************
+ * Definition: Logs the counters
+ **************************************/
+void TranspositionTable::logStats() {
+	float hitRate = 0.0;
+	if (_stats.probes > 0) {
+		hitRate = (float)_stats.hits / _stats.probes;
+	}
+	LOG.write(LOG_MED, "transposition_table", 
+	          "probes: %ld hits: %ld (%.1f%%) stores: %ld replaced: %ld",
+	          _stats.probes, _stats.hits, hitRate * 100.0, 
+	          _stats.stores, _stats.replaced);
+}
@@ -0,0 +1,68 @@
+/**
+ * transposition_table.h
+ *
+ * @brief
+ *      This class remembers what the game search found out about the
+ *      states it has searched, by their Zobrist hash (see Zobrist), so
+ *      a state reached again by a different order of the same moves
+ *      is looked up instead of searched again.
+ *
+ *      It's a fixed size table, a slot per hash. A new result takes
+ *      the slot if it's empty, left over from an older search, or the
+ *      new result searched at least as deep.
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#ifndef CS1567_TRANSPOSITIONTABLE_H
+#define CS1567_TRANSPOSITIONTABLE_H
+
+#include <stdint.h>
+
+#define TT_SIZE_BITS 16     // 2^16 slots of 24 bytes, 1.5 MB
+#define TT_SIZE (1 << TT_SIZE_BITS)
+
+// what a stored value means, since alpha-beta cuts most searches short
+#define TT_EXACT 0
+#define TT_LOWER 1          // the state is worth at least the value
+#define TT_UPPER 2          // the state is worth at most the value
+
+typedef struct {
+	uint64_t key;
+	float value;        // still to be gained from the state
+	int8_t depth;       // plies searched below the state
+	int8_t move;        // board index of the best move, -1 if none
+	uint8_t bound;      // TT_EXACT, TT_LOWER or TT_UPPER
+	uint8_t age;        // the search it was stored in, 0 if empty
+	bool complete;      // searched to the end of the game
+} TTEntry;
+
+typedef struct {
+	long probes;
+	long hits;          // probes that found their state
+	long stores;
+	long replaced;      // stores that overwrote a different state
+} TTStats;
+
+class TranspositionTable {
+public:
+	TranspositionTable();
+	~TranspositionTable();
+	void clear();
+	void newSearch();
+	bool probe(uint64_t key, TTEntry *entry);
+	void store(uint64_t key, int depth, float value, int bound,
+	           int move, bool complete);
+	TTStats getStats();
+	void logStats();
+private:
+	TTEntry *_entries;
+	uint8_t _age;
+	TTStats _stats;
+};
+
+#endif
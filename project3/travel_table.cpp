@@ -0,0 +1,287 @@
+/**
+ * travel_table.cpp
+ *
+ * @brief
+ *      This class keeps how long the robot takes to get from every
+ *      cell, facing every way, to every other cell, going around
+ *      blocked cells and counting the time to turn (SPEED_TURN) as
+ *      well as to drive (SPEED_FORWARD, CELL_SIZE). It's worked out
+ *      with a search over (cell, heading) states from each of them,
+ *      and only again once a cell becomes blocked or unblocked, so
+ *      the planners can score a cell by points per second with a
+ *      single look up.
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#include "travel_table.h"
+#include "robot.h"
+#include "utilities.h"
+#include "logger.h"
+
+#include <math.h>
+
+TravelTable::TravelTable(Map *map) {
+	_map = map;
+	_dirty = true;
+	_rebuilds = 0;
+	_map->subscribe(this);
+}
+
+TravelTable::~TravelTable() {
+	_map->unsubscribe(this);
+}
+
+/**************************************
+ * Definition: Has the table worked out again before it's next used
+ *             if any cell became blocked or unblocked
+ *
+ * Parameters: the changes to the map
+ **************************************/
+void TravelTable::mapChanged(MapChanges *changes) {
+	if (changes->blocked != 0) {
+		_dirty = true;
+	}
+}
+
+/**************************************
+ * Definition: Returns how long it takes to get from one cell to
+ *             another
+ *
+ * Parameters: board index of the cell to start from, the way we're
+ *             facing in it (DIR_NORTH, ...) or -1 if it doesn't
+ *             matter, and board index of the cell to get to
+ *
+ * Returns:    the time in seconds, TRAVEL_UNREACHABLE if blocked
+ *             cells are in the way
+ **************************************/
+float TravelTable::getTime(int from, int heading, int to) {
+	_update();
+	int h = heading == -1 ? _bestHeading(from, to) : _headingIndex(heading);
+	return _time[from * TRAVEL_HEADINGS + h][to];
+}
+
+/**************************************
+ * Definition: Returns the first cell to move to on the quickest way
+ *             from one cell to another
+ *
+ * Parameters: as for getTime
+ *
+ * Returns:    its board index, or -1 if there's no way there
+ **************************************/
+int TravelTable::getFirstMove(int from, int heading, int to) {
+	_update();
+	int h = heading == -1 ? _bestHeading(from, to) : _headingIndex(heading);
+	return _first[from * TRAVEL_HEADINGS + h][to];
+}
+
+/**************************************
+ * Definition: Returns the points a cell is worth for each second it
+ *             takes to get there
+ *
+ * Parameters: as for getTime
+ *
+ * Returns:    the points per second, 0 if it can't be reached
+ **************************************/
+float TravelTable::getPointsPerSecond(int from, int heading, int to) {
+	float time = getTime(from, heading, to);
+	if (time <= 0.0 || time >= TRAVEL_UNREACHABLE) {
+		return 0.0;
+	}
+	return _map->getBoard()->points[to] / time;
+}
+
+/**************************************
+ * Definition: Finds the cell worth the most points per second from
+ *             the given one
+ *
+ * Parameters: board index of the cell to start from and the way
+ *             we're facing in it, or -1 if it doesn't matter
+ *
+ * Returns:    its board index, or -1 if no cell worth points can be
+ *             reached
+ **************************************/
+int TravelTable::getBestTarget(int from, int heading) {
+	BitBoard *board = _map->getBoard();
+	uint64_t pellets = board->pellet & ~board->blocked;
+
+	int best = -1;
+	float bestRate = 0.0;
+	for (int i = 0; i < BOARD_CELLS; i++) {
+		if (!(pellets & BitBoard::bitAt(i)) || i == from) {
+			continue;
+		}
+		float rate = getPointsPerSecond(from, heading, i);
+		if (rate > bestRate) {
+			bestRate = rate;
+			best = i;
+		}
+	}
+	return best;
+}
+
+/**************************************
+ * Definition: Returns how many times the table has been worked out
+ **************************************/
+int TravelTable::getRebuilds() {
+	return _rebuilds;
+}
+
+/**************************************
+ * Definition: Returns how long it takes to drive one cell
+ **************************************/
+float TravelTable::driveTime() {
+	return CELL_SIZE / SPEED_FORWARD[CELL_SPEED];
+}
+
+/**************************************
+ * Definition: Returns how long a quarter turn takes, on average
+ *             between left and right turns
+ **************************************/
+float TravelTable::turnTime() {
+	float speed = (fabs(SPEED_TURN[CELL_SPEED][DIR_LEFT]) +
+	               fabs(SPEED_TURN[CELL_SPEED][DIR_RIGHT])) / 2;
+	return (PI / 2) / speed;
+}
+
+/**************************************
+ * Definition: Works the table out again from every state, if any
+ *             cell has become blocked or unblocked since it last was
+ **************************************/
+void TravelTable::_update() {
+	if (!_dirty) {
+		return;
+	}
+
+	double start = Util::getTime();
+	uint64_t blocked = _map->getBoard()->blocked;
+	for (int state = 0; state < TRAVEL_STATES; state++) {
+		_searchFrom(state, blocked);
+	}
+	_dirty = false;
+	_rebuilds++;
+
+	LOG.write(LOG_LOW, "travel_table", "rebuilt in %f s",
+	          Util::getTime() - start);
+}
+
+/**************************************
+ * Definition: Finds the quickest way from one state to every cell
+ *             with Dijkstra's algorithm. A move to the next cell
+ *             costs the time to turn to face it, if we aren't
+ *             already, and to drive there. The cell we start in may
+ *             be blocked (it's usually the one we're in), but no
+ *             other blocked cell is entered.
+ *
+ * Parameters: the state to start from and the blocked cells
+ **************************************/
+void TravelTable::_searchFrom(int source, uint64_t blocked) {
+	float drive = driveTime();
+	float turn = turnTime();
+
+	float time[TRAVEL_STATES];
+	int8_t first[TRAVEL_STATES];
+	bool done[TRAVEL_STATES];
+	for (int i = 0; i < TRAVEL_STATES; i++) {
+		time[i] = TRAVEL_UNREACHABLE;
+		first[i] = -1;
+		done[i] = false;
+	}
+	time[source] = 0.0;
+
+	while (true) {
+		int state = -1;
+		for (int i = 0; i < TRAVEL_STATES; i++) {
+			if (!done[i] && (state == -1 || time[i] < time[state])) {
+				state = i;
+			}
+		}
+		if (state == -1 || time[state] >= TRAVEL_UNREACHABLE) {
+			break;
+		}
+		done[state] = true;
+
+		int cell = state / TRAVEL_HEADINGS;
+		int heading = state % TRAVEL_HEADINGS;
+		int x = cell % MAP_WIDTH;
+		int y = cell / MAP_WIDTH;
+
+		// north, east, south and west, in heading index order
+		int nextX[TRAVEL_HEADINGS] = {x, x-1, x, x+1};
+		int nextY[TRAVEL_HEADINGS] = {y+1, y, y-1, y};
+		for (int h = 0; h < TRAVEL_HEADINGS; h++) {
+			if (nextX[h] < 0 || nextX[h] >= MAP_WIDTH ||
+			    nextY[h] < 0 || nextY[h] >= MAP_HEIGHT) {
+				continue;
+			}
+			int next = BitBoard::indexOf(nextX[h], nextY[h]);
+			if (blocked & BitBoard::bitAt(next)) {
+				continue;
+			}
+
+			int turns = 0;
+			if (h != heading) {
+				turns = (h + 2) % TRAVEL_HEADINGS == heading ? 2 : 1;
+			}
+			int nextState = next * TRAVEL_HEADINGS + h;
+			float nextTime = time[state] + turns * turn + drive;
+			if (nextTime < time[nextState]) {
+				time[nextState] = nextTime;
+				first[nextState] = state == source ? next : first[state];
+			}
+		}
+	}
+
+	// keep the quickest way into each cell, whichever way we end up
+	// facing
+	for (int to = 0; to < BOARD_CELLS; to++) {
+		int best = to * TRAVEL_HEADINGS;
+		for (int h = 1; h < TRAVEL_HEADINGS; h++) {
+			if (time[to * TRAVEL_HEADINGS + h] < time[best]) {
+				best = to * TRAVEL_HEADINGS + h;
+			}
+		}
+		_time[source][to] = time[best];
+		_first[source][to] = first[best];
+	}
+	_time[source][source / TRAVEL_HEADINGS] = 0.0;
+	_first[source][source / TRAVEL_HEADINGS] = -1;
+}
+
+/**************************************
+ * Definition: Returns the heading to start in that gets from one
+ *             cell to another quickest, for when it doesn't matter
+ *
+ * Returns:    its heading index
+ **************************************/
+int TravelTable::_bestHeading(int from, int to) {
+	int best = 0;
+	for (int h = 1; h < TRAVEL_HEADINGS; h++) {
+		if (_time[from * TRAVEL_HEADINGS + h][to] <
+		    _time[from * TRAVEL_HEADINGS + best][to]) {
+			best = h;
+		}
+	}
+	return best;
+}
+
+/**************************************
+ * Definition: Turns a direction into an index into the table
+ *
+ * Parameters: DIR_NORTH, DIR_EAST, DIR_SOUTH or DIR_WEST
+ **************************************/
+int TravelTable::_headingIndex(int heading) {
+	switch (heading) {
+	case DIR_EAST:
+		return 1;
+	case DIR_SOUTH:
+		return 2;
+	case DIR_WEST:
+		return 3;
+	}
+	return 0;
+}
@@ -0,0 +1,64 @@
+/**
+ * travel_table.h
+ *
+ * @brief
+ *      This class keeps how long the robot takes to get from every
+ *      cell, facing every way, to every other cell, going around
+ *      blocked cells and counting the time to turn (SPEED_TURN) as
+ *      well as to drive (SPEED_FORWARD, CELL_SIZE). It's worked out
+ *      with a search over (cell, heading) states from each of them,
+ *      and only again once a cell becomes blocked or unblocked, so
+ *      the planners can score a cell by points per second with a
+ *      single look up.
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#ifndef CS1567_TRAVELTABLE_H
+#define CS1567_TRAVELTABLE_H
+
+#include "map.h"
+#include "bitboard.h"
+
+#include <stdint.h>
+
+// a state is a cell and which way the robot faces in it
+#define TRAVEL_HEADINGS 4
+#define TRAVEL_STATES (BOARD_CELLS * TRAVEL_HEADINGS)
+
+#define TRAVEL_UNREACHABLE 1.0e9 // seconds
+
+class TravelTable : public MapListener {
+public:
+	TravelTable(Map *map);
+	~TravelTable();
+	void mapChanged(MapChanges *changes);
+	float getTime(int from, int heading, int to);
+	int getFirstMove(int from, int heading, int to);
+	float getPointsPerSecond(int from, int heading, int to);
+	int getBestTarget(int from, int heading);
+	int getRebuilds();
+
+	static float driveTime();
+	static float turnTime();
+private:
+	Map *_map;
+	bool _dirty;            // a cell became blocked or unblocked
+	int _rebuilds;
+
+	// by (from cell, heading) state, then destination cell
+	float _time[TRAVEL_STATES][BOARD_CELLS];
+	int8_t _first[TRAVEL_STATES][BOARD_CELLS];
+
+	void _update();
+	void _searchFrom(int state, uint64_t blocked);
+	int _bestHeading(int from, int to);
+
+	static int _headingIndex(int heading);
+};
+
+#endif
@@ -16,7 +16,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <time.h>
 #include <algorithm>
+#include <vector>
 
 namespace Util {
     /**************************************
@@ -43,6 +45,62 @@ namespace Util {
         }
     }
 
+    /**************************************
+     * Definition: Inverts a square matrix by gauss-jordan elimination
+     *
+     * Parameters: float pointer to the n x n matrix (row major),
+     *             its size as an int and a float pointer to
+     *             store the n x n inverse in
+     *
+     * Returns:    false if the matrix is singular
+     **************************************/
+    bool invertMatrix(float *m, int n, float *inverse) {
+        // augment the matrix with the identity: [m | I]
+        int width = 2*n;
+        std::vector<double> a(n*width, 0.0);
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                a[i*width + j] = m[i*n + j];
+            }
+            a[i*width + n + i] = 1.0;
+        }
+
+        for (int col = 0; col < n; col++) {
+            int pivot = col;
+            for (int i = col+1; i < n; i++) {
+                if (fabs(a[i*width + col]) > fabs(a[pivot*width + col])) {
+                    pivot = i;
+                }
+            }
+            if (fabs(a[pivot*width + col]) < 1e-9) {
+                return false;
+            }
+            for (int j = 0; j < width; j++) {
+                std::swap(a[col*width + j], a[pivot*width + j]);
+            }
+            double scale = a[col*width + col];
+            for (int j = 0; j < width; j++) {
+                a[col*width + j] /= scale;
+            }
+            for (int i = 0; i < n; i++) {
+                if (i == col) {
+                    continue;
+                }
+                double factor = a[i*width + col];
+                for (int j = 0; j < width; j++) {
+                    a[i*width + j] -= factor * a[col*width + j];
+                }
+            }
+        }
+
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                inverse[i*n + j] = a[i*width + n + j];
+            }
+        }
+        return true;
+    }
+
     /**************************************
      * Definition: Takes a theta error, possibly negative, and
      *             converts it to the appropriate representation [-pi, pi]
@@ -127,4 +185,16 @@ namespace Util {
     int capSpeed(int speed, int cap) {
         return std::min(std::max(speed, 1), cap);
     }
+
+    /**************************************
+     * Definition: Returns the time from a clock that only moves
+     *             forward (unaffected by changes to the system clock)
+     *
+     * Returns:    time in seconds as a double
+     **************************************/
+    double getTime() {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return now.tv_sec + now.tv_nsec / 1000000000.0;
+    }
 };
@@ -47,6 +47,7 @@ namespace Util {
     void matrixMult(float *mA, int lA, int hA, 
                     float *mB, int lB, int hB, 
                     float *mC);
+    bool invertMatrix(float *m, int n, float *inverse);
 
     float normalizeThetaError(float thetaError);
     float normalizeTheta(float theta);
@@ -56,6 +57,8 @@ namespace Util {
     int capSpeed(int speed, int cap);
     
     int nameFrom(std::string);
+
+    double getTime();
 };
 
 #endif
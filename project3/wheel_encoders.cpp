@@ -16,6 +16,7 @@
  **/
 
 #include "wheel_encoders.h"
+#include "wheel_kinematics.h"
 #include "constants.h"
 #include "utilities.h"
 #include "logger.h"
@@ -27,6 +28,13 @@ WheelEncoders::WheelEncoders(Robot *robot)
 	_filterLeft = new FIRFilter("filters/we.ffc");
 	_filterRight = new FIRFilter("filters/we.ffc");
 	_filterRear = new FIRFilter("filters/we.ffc");
+
+	_faults = WE_FAULTS[_robot->getName()];
+	_lastSequence = 0;
+	for (int i = 0; i < 3; i++) {
+		_lastTicks[i] = 0;
+	}
+	_buildKinematics();
 }
 
 WheelEncoders::~WheelEncoders() {
@@ -37,112 +45,104 @@ WheelEncoders::~WheelEncoders() {
 
 /************************************************
 * Definition: Translates incremental wheel encoder data to 
-*             global coordinate system and updates robot pose
+*             global coordinate system and updates robot pose.
+*
+*             Each wheel is read and filtered exactly once per
+*             update (filtering advances the filter's state), and
+*             the logs are written from those same values.
 *
-* Note:       Requires the interface be updated prior to calling 
+* Note:       Reads the robot's latest sensor snapshot. The ticks
+*             are taken from the change in its running totals, so
+*             snapshots we never saw still count, and nothing 
+*             happens if it's the same snapshot as last time.
 ************************************************/
 void WheelEncoders::updatePose() {
-	LOG.write(LOG_LOW, "WE_positions_raw", 
-		      "we update (raw): left: %f right: %f rear: %f", 
-		      _getFilteredDeltaLeft(), _getFilteredDeltaRight(), _getFilteredDeltaRear());
-	LOG.write(LOG_LOW, "wheelEncodersUpdate", 
-		      "we update: x: %f deltaX: %f y: %f deltaY: %f", 
-		      getX(), _getDeltaX(), getY(), _getDeltaY());
+	SensorSnapshot *snapshot = _robot->getSnapshot();
+	if (snapshot->sequence == _lastSequence) {
+		return;
+	}
+	long totals[3] = {snapshot->left, snapshot->right, snapshot->rear};
+	long rawTicks[3];
+	for (int i = 0; i < 3; i++) {
+		// the first snapshot only gives us a starting point
+		rawTicks[i] = _lastSequence == 0 ? 0 : totals[i] - _lastTicks[i];
+		_lastTicks[i] = totals[i];
+	}
+	_lastSequence = snapshot->sequence;
 
-	float x = getX() + _getDeltaX();
-	float y = getY() + _getDeltaY();
-	float theta = Util::normalizeTheta(getTheta() + _getDeltaTheta());
+	float ticks[3];
+	ticks[0] = _filterLeft->filter((float)rawTicks[0]);
+	ticks[1] = _filterRight->filter((float)rawTicks[1]);
+	ticks[2] = _filterRear->filter((float)rawTicks[2]);
 
-	_pose->setX(x);
-	_pose->setY(y);
-	_pose->setTheta(theta);
-}
+	// motion in the robot's frame
+	float motion[3];
+	for (int i = 0; i < 3; i++) {
+		motion[i] = 0.0;
+		for (int j = 0; j < 3; j++) {
+			motion[i] += _kinematics[i*3 + j] * ticks[j];
+		}
+		motion[i] /= WE_SCALE;
+	}
+	float lateral = motion[WE_LATERAL];
+	float forward = motion[WE_FORWARD];
+	float deltaTheta = motion[WE_ROTATION] / (ROBOT_DIAMETER / 2.0);
 
-/************************************************
- * Definition: Translates wheel encoder motion from robot axis 
- *             into the corresponding change in X in the global coordinate system  
- *
- * Returns:    delta x in terms of global coordinate system 
- ***********************************************/
-float WheelEncoders::_getDeltaX() {
-	float scaledDeltaX = _getRobotDeltaY() / WE_SCALE;
-	float rotatedDeltaX = scaledDeltaX * cos(getTheta());
-    return rotatedDeltaX;
-}
+	// rotate into the global frame using the heading we had
+	// before this update (lateral is to the robot's right)
+	float theta = getTheta();
+	float sinTheta, cosTheta;
+	sincosf(theta, &sinTheta, &cosTheta);
+	float deltaX = forward * cosTheta + lateral * sinTheta;
+	float deltaY = forward * sinTheta - lateral * cosTheta;
 
-/************************************************
- * Definition: Translates wheel encoder motion from robot axis 
- *             into the corresponding change in Y in the global coordinate system  
- *
- * Returns:    delta y in terms of global coordinate system 
- ***********************************************/
-float WheelEncoders::_getDeltaY() {
-	float scaledDeltaY = _getRobotDeltaY() / WE_SCALE;
-	float rotatedDeltaY = scaledDeltaY * sin(getTheta());
-    return rotatedDeltaY;
-}
+	LOG.write(LOG_LOW, "WE_positions_raw", 
+		      "we update (raw): left: %f right: %f rear: %f", 
+		      ticks[0], ticks[1], ticks[2]);
+	LOG.write(LOG_LOW, "wheelEncodersUpdate", 
+		      "we update: x: %f deltaX: %f y: %f deltaY: %f "
+		      "lateral: %f forward: %f deltaTheta: %f", 
+		      getX(), deltaX, getY(), deltaY, 
+		      lateral, forward, deltaTheta);
 
-/************************************************
- * Definition: Translates wheel encoder motion from robot axis 
- *             into the corresponding change in theta in the global coordinate system  
- *
- * Returns:    delta theta in terms of global coordinate system 
- ***********************************************/
-float WheelEncoders::_getDeltaTheta() {
-	float rearRobotDeltaX = _getFilteredDeltaRear();
-	float scaledRobotDeltaX = rearRobotDeltaX / WE_SCALE;
-	return -scaledRobotDeltaX / (ROBOT_DIAMETER / 2.0);
+	_pose.setX(getX() + deltaX);
+	_pose.setY(getY() + deltaY);
+	_pose.setTheta(theta + deltaTheta);
 }
 
 /************************************************
- * Definition: Translates wheel encoder ticks into the robot coordinate system  
+ * Definition: Sets which wheels have bad encoders and rebuilds
+ *             the kinematics without them
  *
- * Returns:    delta y in robot coordinate system
+ * Parameters: int mask of WE_FAULT_* values
  ***********************************************/
-float WheelEncoders::_getRobotDeltaY() {
-    float leftRobotDeltaY = -_getFilteredDeltaLeft() * cos(DEGREE_150);
-    float rightRobotDeltaY = _getFilteredDeltaRight() * cos(DEGREE_30);
-    // some robots have bad wheel encoders for one side,
-    // so account for this by faking the data on the opposite
-    // wheel
-    switch (_robot->getName()) {
-    case ROSIE:
-    	rightRobotDeltaY = leftRobotDeltaY;
-    	break;
-    case OPTIMUS:
-    	leftRobotDeltaY = rightRobotDeltaY;
-    	break;
-    }
-    float avgRobotDeltaY = (leftRobotDeltaY + rightRobotDeltaY) / 2.0;
-    return avgRobotDeltaY;
+void WheelEncoders::setFaults(int faults) {
+	_faults = faults;
+	_buildKinematics();
 }
 
 /************************************************
- * Definition: Returns filtered wheel encoder ticks for left wheel
- *
- * Returns:    delta left ticks
+ * Definition: Returns the mask of wheels with bad encoders
  ***********************************************/
-float WheelEncoders::_getFilteredDeltaLeft() {
-    int left = _robot->getInterface()->getWheelEncoder(RI_WHEEL_LEFT);
-    return _filterLeft->filter((float) left);
+int WheelEncoders::getFaults() {
+	return _faults;
 }
 
 /************************************************
- * Definition: Returns filtered wheel encoder ticks for right wheel
- *
- * Returns:    delta right ticks
+ * Definition: Works out the matrix used by updatePose from the
+ *             wheels that have good encoders (see WheelKinematics)
  ***********************************************/
-float WheelEncoders::_getFilteredDeltaRight() {
-    int right = _robot->getInterface()->getWheelEncoder(RI_WHEEL_RIGHT);
-    return _filterRight->filter((float) right);
-}
+void WheelEncoders::_buildKinematics() {
+	if (!WheelKinematics::build(_faults, _kinematics)) {
+		LOG.write(LOG_HIGH, "wheel_encoders", 
+		          "no usable wheel encoders (faults: %d)", _faults);
+		return;
+	}
 
-/************************************************
- * Definition: Returns filtered wheel encoder ticks for rear wheel
- *
- * Returns:    delta rear ticks
- ***********************************************/
-float WheelEncoders::_getFilteredDeltaRear() {
-    int rear = _robot->getInterface()->getWheelEncoder(RI_WHEEL_REAR);
-    return _filterRear->filter((float) rear);
+	LOG.write(LOG_MED, "wheel_encoders", 
+	          "kinematics (faults: %d): [%f %f %f] [%f %f %f] [%f %f %f]",
+	          _faults, 
+	          _kinematics[0], _kinematics[1], _kinematics[2],
+	          _kinematics[3], _kinematics[4], _kinematics[5],
+	          _kinematics[6], _kinematics[7], _kinematics[8]);
 }
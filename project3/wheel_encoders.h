@@ -26,18 +26,23 @@ public:
 	WheelEncoders(Robot *robot);
 	~WheelEncoders();
 	void updatePose();
+	void setFaults(int faults);
+	int getFaults();
 private:
 	FIRFilter *_filterLeft;
 	FIRFilter *_filterRight;
 	FIRFilter *_filterRear;
 
-	float _getDeltaX();
-	float _getDeltaY();
-	float _getDeltaTheta();
-	float _getRobotDeltaY();
-	float _getFilteredDeltaLeft();
-	float _getFilteredDeltaRight();
-	float _getFilteredDeltaRear();
+	// maps (left, right, rear) ticks to (lateral, forward, rotation)
+	// ticks in the robot frame, row major
+	float _kinematics[9];
+	int _faults;
+
+	// the snapshot's running tick totals as of our last update
+	unsigned int _lastSequence;
+	long _lastTicks[3];
+
+	void _buildKinematics();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,97 @@
+/**
+ * wheel_kinematics.cpp
+ * 
+ * @brief 
+ * 		This class works out the matrix that turns the ticks of the 
+ *      left, right and rear wheels into the robot's lateral, forward 
+ *      and rotational motion, from the omni wheels' geometry, using 
+ *      only the wheels whose encoders can be trusted.
+ * 
+ * @author
+ * 		Shawn Hanna
+ * 		Tom Nason
+ * 		Joel Griffith
+ *
+ **/
+
+#include "wheel_kinematics.h"
+#include "constants.h"
+#include "utilities.h"
+
+// Ticks each wheel turns per unit of robot motion (the forward 
+// kinematics), with columns lateral (to the right), forward and 
+// rotation (counter-clockwise, as arc length at the wheels). The 
+// front wheels sit at 150 and 30 degrees and the rear wheel at 270,
+// with positive left/right ticks driving forward and positive rear 
+// ticks turning clockwise.
+const float WE_FORWARD_KINEMATICS[3][3] = {
+	{ 0.5,  0.866025404, -1.0}, // left
+	{-0.5,  0.866025404,  1.0}, // right
+	{-1.0,  0.0,         -1.0}  // rear
+};
+
+/************************************************
+ * Definition: Inverts the forward kinematics of the wheels that
+ *             have good encoders into a matrix that maps (left, 
+ *             right, rear) ticks to (lateral, forward, rotation),
+ *             row major.
+ *
+ *             With all three wheels the lateral, forward and 
+ *             rotational motion can all be solved for. Every wheel 
+ *             that is lost gives up one of them, lateral first
+ *             (it's assumed to be zero), then rotation if the rear
+ *             wheel is still good, or forward if it isn't.
+ *
+ *             The forward row is scaled by WE_FORWARD_GAIN after the 
+ *             inverse, so straight line distance still matches 
+ *             WE_SCALE without mixing the other axes into it.
+ *
+ * Parameters: int mask of WE_FAULT_* values and the 9 floats to 
+ *             store the matrix in
+ *
+ * Returns:    false if no wheels are usable (the matrix is all 0)
+ ***********************************************/
+bool WheelKinematics::build(int faults, float *kinematics) {
+	int wheels[3];
+	int numWheels = 0;
+	for (int i = 0; i < 3; i++) {
+		if (!(faults & (1 << i))) {
+			wheels[numWheels++] = i;
+		}
+	}
+
+	int axes[3];
+	int numAxes = 0;
+	if (numWheels == 3) {
+		axes[numAxes++] = WE_LATERAL;
+	}
+	if (numWheels >= 2 || (numWheels == 1 && wheels[0] != 2)) {
+		axes[numAxes++] = WE_FORWARD;
+	}
+	if (numWheels >= 2 || (numWheels == 1 && wheels[0] == 2)) {
+		axes[numAxes++] = WE_ROTATION;
+	}
+
+	for (int i = 0; i < 9; i++) {
+		kinematics[i] = 0.0;
+	}
+
+	float reduced[9];
+	float inverse[9];
+	for (int i = 0; i < numWheels; i++) {
+		for (int j = 0; j < numAxes; j++) {
+			reduced[i*numAxes + j] = WE_FORWARD_KINEMATICS[wheels[i]][axes[j]];
+		}
+	}
+	if (numWheels == 0 || !Util::invertMatrix(reduced, numWheels, inverse)) {
+		return false;
+	}
+
+	for (int i = 0; i < numAxes; i++) {
+		float gain = axes[i] == WE_FORWARD ? WE_FORWARD_GAIN : 1.0;
+		for (int j = 0; j < numWheels; j++) {
+			kinematics[axes[i]*3 + wheels[j]] = gain * inverse[i*numWheels + j];
+		}
+	}
+	return true;
+}
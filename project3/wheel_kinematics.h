@@ -0,0 +1,33 @@
+/**
+ * wheel_kinematics.h
+ * 
+ * @brief 
+ * 		This class works out the matrix that turns the ticks of the 
+ *      left, right and rear wheels into the robot's lateral, forward 
+ *      and rotational motion, from the omni wheels' geometry, using 
+ *      only the wheels whose encoders can be trusted.
+ * 
+ * @author
+ * 		Shawn Hanna
+ * 		Tom Nason
+ * 		Joel Griffith
+ *
+ **/
+
+#ifndef CS1567_WHEELKINEMATICS_H
+#define CS1567_WHEELKINEMATICS_H
+
+#define WE_LATERAL 0
+#define WE_FORWARD 1
+#define WE_ROTATION 2
+
+// WE_SCALE was measured as the cos(30) projection of the front wheels'
+// ticks, which reads cos(30)^2 of the true forward distance
+#define WE_FORWARD_GAIN 0.75
+
+class WheelKinematics {
+public:
+	static bool build(int faults, float *kinematics);
+};
+
+#endif
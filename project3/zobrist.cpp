@@ -0,0 +1,58 @@
+/**
+ * zobrist.cpp
+ *
+ * @brief
+ *      This class holds a random 64 bit key for every part of a game
+ *      state (each blocked cell, each robot on each cell, our heading
+ *      and whose turn it is). A state's hash is the xor of the keys
+ *      of its parts, so a move updates it with a few xors and two
+ *      orders of the same moves hash the same.
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#include "zobrist.h"
+
+Zobrist::Zobrist() {
+	_state = ZOBRIST_SEED;
+	for (int i = 0; i < BOARD_CELLS; i++) {
+		blocked[i] = _next();
+		us[i] = _next();
+		them[i] = _next();
+	}
+	for (int i = 0; i <= DIR_WEST; i++) {
+		heading[i] = _next();
+	}
+	theirTurn = _next();
+}
+
+Zobrist::~Zobrist() {}
+
+/**************************************
+ * Definition: Hashes a set of blocked cells from scratch
+ *
+ * Parameters: the blocked cells' mask
+ **************************************/
+uint64_t Zobrist::hashBlocked(uint64_t cells) {
+	uint64_t hash = 0;
+	for (int i = 0; i < BOARD_CELLS; i++) {
+		if (cells & BitBoard::bitAt(i)) {
+			hash ^= blocked[i];
+		}
+	}
+	return hash;
+}
+
+/**************************************
+ * Definition: Generates the next key (xorshift64*)
+ **************************************/
+uint64_t Zobrist::_next() {
+	_state ^= _state >> 12;
+	_state ^= _state << 25;
+	_state ^= _state >> 27;
+	return _state * 0x2545F4914F6CDD1DULL;
+}
@@ -0,0 +1,44 @@
+/**
+ * zobrist.h
+ *
+ * @brief
+ *      This class holds a random 64 bit key for every part of a game
+ *      state (each blocked cell, each robot on each cell, our heading
+ *      and whose turn it is). A state's hash is the xor of the keys
+ *      of its parts, so a move updates it with a few xors and two
+ *      orders of the same moves hash the same.
+ *
+ * @author
+ *      Shawn Hanna
+ *      Tom Nason
+ *      Joel Griffith
+ *
+ **/
+
+#ifndef CS1567_ZOBRIST_H
+#define CS1567_ZOBRIST_H
+
+#include "map.h"
+#include "bitboard.h"
+
+// the keys are the same every run, so searches can be replayed
+#define ZOBRIST_SEED 0x9E3779B97F4A7C15ULL
+
+class Zobrist {
+public:
+	Zobrist();
+	~Zobrist();
+	uint64_t hashBlocked(uint64_t blocked);
+
+	uint64_t blocked[BOARD_CELLS];
+	uint64_t us[BOARD_CELLS];
+	uint64_t them[BOARD_CELLS];
+	uint64_t heading[DIR_WEST + 1];  // indexed by DIR_*, 0 for none
+	uint64_t theirTurn;
+private:
+	uint64_t _next();
+
+	uint64_t _state;
+};
+
+#endif